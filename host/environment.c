@@ -0,0 +1,137 @@
+/*************************************************************************
+Title: Environment
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	A batch of solo games of snake for a program to learn to play, e.g. by
+	reinforcement learning, built on the lockstep engine, see lockstep.c.
+	A game is reset from a seed, and then stepped with an arrow to press,
+	or NONE to carry on, each step giving it a reward and telling whether
+	it is done:
+
+	  - REWARD_FOOD when the snake eats, including the food it wins on,
+	  - REWARD_CRASH when it crashes, which ends the game,
+	  - REWARD_NONE otherwise, and on every step of a game that is done.
+
+	A game that is done stays as it ended until it is reset, which may be
+	done between any two steps. Every game of a batch is stepped at once,
+	as the lanes of the engine step together; a game is played alone by
+	pressing NONE in the others, or by leaving them done.
+
+	A game is observed where the engine keeps it, with nothing copied: the
+	walls buffer caching its view, in the console's own layout, and the
+	head, food and view, see the interface of environment.h. The buffer is
+	only valid up to the next step or reset of the batch.
+
+	A batch keeps all of its state, so any number may be played at once,
+	one per thread if need be. Nothing is allocated but the batch itself.
+
+*************************************************************************/
+
+#include <stdlib.h>
+#include "environment.h"
+
+
+/*
+ * Function:  environment_create
+ * ------------------------------
+ * Allocates a batch of games of a level. Every game is done, until it is
+ * reset.
+ *
+ *  level: A walls buffer holding nothing but the level, e.g. after load_level().
+ *
+ *  returns: The batch, or NULL if there is not the memory for it.
+ *
+ */
+environment_t* environment_create(const byte level[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE]) {
+	environment_t* env = calloc(1, sizeof(environment_t));
+	uint8_t index;
+
+	if (env == NULL) return NULL;
+	env->games = lockstep_create(level);
+	if (env->games == NULL) {
+		free(env);
+		return NULL;
+	}
+	env->games->cache_views = TRUE;
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		env->done[index] = TRUE;
+	}
+	return env;
+}
+
+void environment_destroy(environment_t* env) {
+	if (env == NULL) return;
+	lockstep_destroy(env->games);
+	free(env);
+	return;
+}
+
+
+/*
+ * Function:  environment_reset
+ * -----------------------------
+ * Starts a new game, with its reward cleared. A game depends only on its seed
+ * and the actions it is stepped with.
+ *
+ *  index: The game to reset.
+ *  seed: Seeds the food, as seed_food() does.
+ *
+ */
+void environment_reset(environment_t* env, uint8_t index, uint16_t seed) {
+	lockstep_start(env->games, index, seed);
+	env->reward[index] = REWARD_NONE;
+	env->done[index] = FALSE;
+	return;
+}
+
+
+/*
+ * Function:  environment_step
+ * ----------------------------
+ * Steps every game of a batch by a tick, and sets the reward and whether
+ * each is done.
+ *
+ *  actions: The arrow pressed in each game, or NONE.
+ *
+ *  returns: The number of games not done.
+ *
+ */
+uint8_t environment_step(environment_t* env, const direction_t actions[]) {
+	lockstep_t* games = env->games;
+	uint8_t index, playing = lockstep_step(games, actions);
+	bool crashed;
+
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		crashed = games->status[index] == LANE_CRASHED;
+		env->reward[index] = games->ate[index] ? REWARD_FOOD : REWARD_NONE;
+		env->reward[index] = (crashed & !env->done[index]) ? REWARD_CRASH : env->reward[index];
+		env->done[index] = games->status[index] != LANE_PLAYING;
+	}
+	return playing;
+}
+
+
+/*
+ * Function:  environment_cell
+ * ----------------------------
+ * Reads a world cell in a game's view from its walls buffer, as get_object()
+ * does on the console.
+ *
+ *  returns: What is in the cell, WALL off the world, or EMPTY if it is out
+ *           of view.
+ *
+ */
+obj_t environment_cell(const environment_t* env, uint8_t index, point_t pt) {
+	int8_t dx = pt.x - env->games->view_x[index], dy = pt.y - env->games->view_y[index];
+	uint8_t row = pt.y % MAX_SNAKE_ROW;
+
+	if (OFF_WORLD(pt)) return WALL;
+	if (dx < 0) dx += WORLD_COLUMNS;
+	if (dy < 0) dy += WORLD_ROWS;
+	if (dx >= MAX_SNAKE_COLUMN || dy >= MAX_SNAKE_ROW) return EMPTY;
+	return (env->games->walls[index][pt.x % MAX_SNAKE_COLUMN][row / SNAKE_ROWS_PER_PAGE] >>
+			(SNAKE_ROW_BIT_SIZE*(row % SNAKE_ROWS_PER_PAGE))) & 0b11;
+}
@@ -0,0 +1,47 @@
+/*************************************************************************
+Title:    Environment Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	A batch of solo games of snake to be played by a program, a step of
+	every game at a time, each step rewarding or ending a game. See
+	environment.c.
+
+*************************************************************************/
+
+#ifndef _ENVIRONMENT_H_
+#define _ENVIRONMENT_H_
+
+#include "lockstep.h"
+
+#define ENVIRONMENTS		LOCKSTEP_LANES	// Games in a batch, one per lane
+
+typedef struct {
+	lockstep_t* games;				// Observed in place, see the interface below
+	float reward[ENVIRONMENTS];		// Of the last step
+	bool done[ENVIRONMENTS];		// Until the game is reset
+} environment_t;
+
+// Environment function declarations
+environment_t*	environment_create(const byte level[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE]);
+void 			environment_destroy(environment_t* env);
+void 			environment_reset(environment_t* env, uint8_t index, uint16_t seed);
+uint8_t 		environment_step(environment_t* env, const direction_t actions[]);
+obj_t 			environment_cell(const environment_t* env, uint8_t index, point_t pt);
+
+//Environment Interface
+#define REWARD_FOOD			1.0f
+#define REWARD_CRASH		(-1.0f)
+#define REWARD_NONE			0.0f
+
+// Observations of a game, read from the engine without copying
+#define ENV_WALLS(ENV,I)	((const byte (*)[MAX_SNAKE_PAGE])(ENV)->games->walls[I])	// The view, as the console's walls buffer
+#define ENV_HEAD(ENV,I)		((point_t){(ENV)->games->head_x[I], (ENV)->games->head_y[I]})
+#define ENV_FOOD(ENV,I)		((point_t){(ENV)->games->food_x[I], (ENV)->games->food_y[I]})
+#define ENV_VIEW(ENV,I)		((point_t){(ENV)->games->view_x[I], (ENV)->games->view_y[I]})
+#define ENV_DIRECTION(ENV,I)	((ENV)->games->dir[I])
+
+/*** End of Environment Header File ****/
+#endif
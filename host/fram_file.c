@@ -0,0 +1,112 @@
+/*************************************************************************
+Title: Host FRAM
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None
+
+DESCRIPTION:
+	File-backed stand-in for the FRAM driver in src/fram.c. The FRAM is 
+	kept in memory and every write goes straight through to the image 
+	file, so its contents outlive a run just as they outlive a power 
+	cycle on the console. The image is fram.bin, or the file named by 
+	$SNAKE_FRAM. The traffic counters match the real driver.
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "console.h"
+#include "fram.h"
+
+fram_stats_t fram_stats = {0};
+static byte fram_image[FRAM_SIZE];
+static FILE* fram_file = NULL;
+
+
+/*
+ * Function:  fram_init
+ * ---------------------
+ * Opens the image file, creating it if it does not exist yet. Without a file
+ * the FRAM still works, but forgets its contents when the tool exits.
+ *
+ */
+void fram_init(void) {
+	const char* path = getenv("SNAKE_FRAM");
+	
+	if (path == NULL) path = "fram.bin";
+	if (fram_file != NULL) fclose(fram_file);
+	memset(fram_image, 0x00, sizeof(fram_image));
+	fram_file = fopen(path, "r+b");
+	if (fram_file == NULL) fram_file = fopen(path, "w+b");
+	if (fram_file == NULL) {
+		perror(path);
+		return;
+	}
+	if (fread(fram_image, 1, sizeof(fram_image), fram_file) < sizeof(fram_image)) {
+		fseek(fram_file, 0, SEEK_SET);
+		fwrite(fram_image, 1, sizeof(fram_image), fram_file);
+		fflush(fram_file);
+	}
+	return;
+}
+
+byte fram_transfer(byte data) {
+	return 0x00;
+}
+
+void fram_begin(byte opcode, uint16_t address) {
+	return;
+}
+
+void fram_read(uint16_t address, byte* data, uint16_t length) {
+	fram_stats.reads++;
+	fram_stats.bytes_read += length;
+	while (length--) {
+		*data++ = fram_image[address++ % FRAM_SIZE];
+	}
+	return;
+}
+
+
+/*
+ * Function:  fram_store
+ * ----------------------
+ * Copies a range of the in-memory FRAM out to the image file.
+ *
+ */
+static void fram_store(uint16_t address, uint16_t length) {
+	if (fram_file == NULL) return;
+	fseek(fram_file, address, SEEK_SET);
+	fwrite(&fram_image[address], 1, length, fram_file);
+	fflush(fram_file);
+	return;
+}
+
+void fram_write(uint16_t address, const byte* data, uint16_t length) {
+	fram_stats.writes++;
+	fram_stats.bytes_written += length;
+	assert(address + length <= FRAM_SIZE);
+	memcpy(&fram_image[address], data, length);
+	fram_store(address, length);
+	return;
+}
+
+void fram_fill(uint16_t address, byte value, uint16_t length) {
+	fram_stats.writes++;
+	fram_stats.bytes_written += length;
+	assert(address + length <= FRAM_SIZE);
+	memset(&fram_image[address], value, length);
+	fram_store(address, length);
+	return;
+}
+
+byte fram_read_byte(uint16_t address) {
+	byte value;
+	fram_read(address, &value, 1);
+	return value;
+}
+
+void fram_write_byte(uint16_t address, byte value) {
+	fram_write(address, &value, 1);
+	return;
+}
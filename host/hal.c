@@ -0,0 +1,99 @@
+/*************************************************************************
+Title: Host Hardware Abstraction
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None
+
+DESCRIPTION:
+	Registers and memory introspection for the host build. The registers
+	are plain variables, and the buttons are read as released (pins high)
+	until a tool pulls them low and raises INT1_vect() itself.
+
+	The heap is glibc's, so the allocator statistics come from mallinfo2()
+	and there is no painted stack to measure. Cycles are wall-clock time
+	scaled by F_CPU, so they are only comparable between host runs.
+
+*************************************************************************/
+
+#include <malloc.h>
+#include <time.h>
+#include "console.h"
+
+volatile uint8_t DDRB, DDRC, DDRD;
+volatile uint8_t PORTB, PORTC, PORTD;
+volatile uint8_t PINC = ALL, PIND = ALL;
+volatile uint8_t GICR, MCUCR, TIMSK, TCCR0, TCCR1B, OCR0;
+volatile uint8_t ADMUX, ADCL, ADCH;
+volatile uint8_t SPCR, SPSR, SPDR;
+volatile uint8_t UBRRH, UBRRL, UCSRB, UCSRC, UDR;
+volatile uint8_t SREG;
+
+static volatile uint8_t adcsra;
+static uint32_t heap_allocations = 0;
+static uint16_t heap_live_blocks = 0;
+static size_t heap_peak = 0;
+
+
+volatile uint8_t* host_adcsra(void) {
+	adcsra &= ~_BV(ADSC);
+	return &adcsra;
+}
+
+int check_free_ram(void) {
+	return 0;
+}
+
+void* heap_alloc(size_t size) {
+	void* ptr = malloc(size);
+	size_t used;
+	
+	if (ptr != NULL) {
+		heap_allocations++;
+		heap_live_blocks++;
+		used = mallinfo2().uordblks;
+		if (used > heap_peak) heap_peak = used;
+	}
+	return ptr;
+}
+
+void heap_free(void* ptr) {
+	if (ptr != NULL) {
+		heap_live_blocks--;
+		free(ptr);
+	}
+	return;
+}
+
+void get_heap_stats(heap_stats_t* stats) {
+	struct mallinfo2 info = mallinfo2();
+	stats->allocations = heap_allocations;
+	stats->live_blocks = heap_live_blocks;
+	stats->free_blocks = info.ordblks;
+	stats->largest_free = 0;
+	stats->used = info.uordblks;
+	stats->peak = heap_peak;
+	return;
+}
+
+void reset_heap_peak(void) {
+	heap_peak = 0;
+	return;
+}
+
+uint16_t stack_high_water(void) {
+	return 0;
+}
+
+void repaint_stack(void) {
+	return;
+}
+
+uint16_t stack_headroom(void) {
+	return 0;
+}
+
+uint32_t get_cycles(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((now.tv_sec * 1000000000ULL + now.tv_nsec) * (F_CPU / 1000) / 1000000);
+}
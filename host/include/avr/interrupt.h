@@ -0,0 +1,24 @@
+/*************************************************************************
+Title:    Host AVR Interrupt Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None
+
+DESCRIPTION:
+	Stand-in for <avr/interrupt.h>. An ISR becomes an ordinary function
+	named after its vector, which host tools call to raise the interrupt.
+
+*************************************************************************/
+
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+#define ISR(vector)		void vector(void); void vector(void)
+#define sei()
+#define cli()
+
+void INT1_vect(void);
+void TIMER1_OVF_vect(void);
+void USART_UDRE_vect(void);
+
+#endif
@@ -0,0 +1,92 @@
+/*************************************************************************
+Title:    Host AVR I/O Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None
+
+DESCRIPTION:
+	Stand-in for <avr/io.h> in the host build. The ATmega16 registers 
+	used by the console are plain variables (see hal.c), so the game 
+	sources compile unchanged on a PC. Only the bits the console uses
+	are defined.
+
+*************************************************************************/
+
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit) 	(1 << (bit))
+
+extern volatile uint8_t DDRB, DDRC, DDRD;
+extern volatile uint8_t PORTB, PORTC, PORTD;
+extern volatile uint8_t PINC, PIND;
+extern volatile uint8_t GICR, MCUCR, TIMSK, TCCR0, TCCR1B, OCR0;
+extern volatile uint8_t ADMUX, ADCL, ADCH;
+extern volatile uint8_t SPCR, SPSR, SPDR;
+extern volatile uint8_t UBRRH, UBRRL, UCSRB, UCSRC, UDR;
+extern volatile uint8_t SREG;
+
+// A conversion completes as soon as its result is waited on
+extern volatile uint8_t* host_adcsra(void);
+#define ADCSRA 		(*host_adcsra())
+
+/*Port Pins*/
+#define PA3		3
+#define PB0		0
+#define PB1		1
+#define PB2		2
+#define PB3		3
+#define PB4		4
+#define PB5		5
+#define PB6		6
+#define PB7		7
+#define PC0		0
+#define PC1		1
+#define PC6		6
+#define PD0		0
+#define PD1		1
+#define PD2		2
+#define PD4		4
+#define PD5		5
+#define PD6		6
+#define PD7		7
+
+/*Register Bits*/
+#define INT1	7
+#define ISC10	2
+#define ISC11	3
+#define TOIE1	2
+#define CS10	0
+#define CS12	2
+#define CS00	0
+#define CS01	1
+#define WGM01	3
+#define COM01	5
+#define WGM00	6
+#define SPR0	0
+#define SPI2X	0
+#define CPHA	2
+#define CPOL	3
+#define MSTR	4
+#define DORD	5
+#define SPE		6
+#define SPIE	7
+#define MUX0	0
+#define MUX1	1
+#define ADLAR	5
+#define REFS0	6
+#define REFS1	7
+#define ADPS0	0
+#define ADPS1	1
+#define ADPS2	2
+#define ADSC	6
+#define ADEN	7
+#define UCSZ0	1
+#define UCSZ1	2
+#define TXEN	3
+#define UDRIE	5
+#define URSEL	7
+
+#endif
@@ -0,0 +1,22 @@
+/*************************************************************************
+Title:    Host AVR Program Space Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None
+
+DESCRIPTION:
+	Stand-in for <avr/pgmspace.h>. Flash and RAM share one address space
+	on the host.
+
+*************************************************************************/
+
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+
+#endif
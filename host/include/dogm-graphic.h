@@ -0,0 +1,43 @@
+/*************************************************************************
+Title:    Host LCD Library Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: DOGS102 emulator
+
+DESCRIPTION:
+	Host replacement for lcdlib's dogm-graphic.h. Only the part of the 
+	library used by the console is provided. Every command and data byte 
+	is clocked into the ST7565 emulator with the same A0 framing as the 
+	real library, so the byte stream matches the hardware (see lcd.c).
+
+*************************************************************************/
+
+#ifndef _HOST_DOGM_GRAPHIC_H_
+#define _HOST_DOGM_GRAPHIC_H_
+
+#include <stdint.h>
+#include "st7565.h"
+
+// LCD library function declarations
+void 	lcd_init(void);
+void 	lcd_command(uint8_t cmd);
+void 	lcd_data(uint8_t data);
+void 	lcd_moveto_xy(uint8_t page, uint8_t column);
+void 	lcd_clear_area_xy(uint8_t pages, uint8_t columns, uint8_t style, uint8_t page, uint8_t col);
+void 	lcd_set_font(uint8_t font, uint8_t style);
+uint8_t lcd_putc(char c);
+uint8_t lcd_putstr(char* str);
+void 	lcd_put_int(int16_t val);
+void 	lcd_put_uint(uint16_t val);
+
+// The emulated display the library writes to
+extern st7565_t lcd_emulator;
+
+//LCD Library Interface
+#define LCD_RAM_PAGES		8
+#define LCD_WIDTH			102
+#define NORMAL				0
+#define FONT_FIXED_8		0
+#define FONT_WIDTH			6	// Columns per character, including the gap
+
+#endif
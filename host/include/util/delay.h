@@ -0,0 +1,19 @@
+/*************************************************************************
+Title:    Host AVR Delay Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None
+
+DESCRIPTION:
+	Stand-in for <util/delay.h>. Host tools run as fast as they can, so
+	busy-waits are dropped.
+
+*************************************************************************/
+
+#ifndef _HOST_UTIL_DELAY_H_
+#define _HOST_UTIL_DELAY_H_
+
+#define _delay_ms(ms)	((void)(ms))
+#define _delay_us(us)	((void)(us))
+
+#endif
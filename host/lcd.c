@@ -0,0 +1,132 @@
+/*************************************************************************
+Title: Host LCD Library
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: DOGS102 emulator
+
+DESCRIPTION:
+	Host replacement for the part of lcdlib used by the console. Bytes
+	are framed the way the real library frames them: chip-select low, A0
+	low for a command or high for data, one SPI byte, then chip-select 
+	high. The emulator samples A0 from PORTD, just like the display does.
+
+	Text uses a placeholder glyph of the same width as the real font, so 
+	the byte counts match the hardware but the letters are not readable.
+
+*************************************************************************/
+
+#include <stdio.h>
+#include "console.h"
+#include "dogm-graphic.h"
+
+st7565_t lcd_emulator;
+
+
+/*
+ * Function:  lcd_transfer
+ * ------------------------
+ * Sends one byte to the display over the emulated SPI bus.
+ *
+ */
+static void lcd_transfer(uint8_t value) {
+	LCD_CHIP_SELECT;
+	st7565_write(&lcd_emulator, GET(PORTD, LCD_A0_PIN), value);
+	LCD_CHIP_DESELECT;
+	return;
+}
+
+void lcd_command(uint8_t cmd) {
+	LCD_COMMAND;
+	lcd_transfer(cmd);
+	return;
+}
+
+void lcd_data(uint8_t data) {
+	LCD_DATA;
+	lcd_transfer(data);
+	return;
+}
+
+
+/*
+ * Function:  lcd_init
+ * --------------------
+ * Resets the display and sends the DOGS102 start-up sequence from its datasheet.
+ *
+ */
+void lcd_init(void) {
+	static const uint8_t init_sequence[] = {
+		0x40, 0xA1, 0xC0, 0xA4, 0xA6, 0xA2, 0x2F, 0x27, 0x81, 0x10, 0xFA, 0x90, 0xAF
+	};
+	uint8_t i;
+
+	LCD_CHIP_SELECT_DIR(OUT);
+	LCD_RESET_DIR(OUT);
+	LCD_A0_DIR(OUT);
+	st7565_reset(&lcd_emulator);
+	for (i = 0; i < sizeof(init_sequence); i++) {
+		lcd_command(init_sequence[i]);
+	}
+	return;
+}
+
+void lcd_moveto_xy(uint8_t page, uint8_t column) {
+	lcd_command(CMD_PAGE | (page & 0x0F));
+	lcd_command(CMD_COL_LSB | (column & 0x0F));
+	lcd_command(CMD_COL_MSB | ((column >> 4) & 0x0F));
+	return;
+}
+
+void lcd_clear_area_xy(uint8_t pages, uint8_t columns, uint8_t style, uint8_t page, uint8_t col) {
+	uint8_t i, j;
+	for (i = 0; i < pages; i++) {
+		lcd_moveto_xy(page + i, col);
+		for (j = 0; j < columns; j++) {
+			lcd_data(style == NORMAL ? 0x00 : 0xFF);
+		}
+	}
+	return;
+}
+
+void lcd_set_font(uint8_t font, uint8_t style) {
+	return;
+}
+
+
+/*
+ * Function:  lcd_putc
+ * --------------------
+ * Writes a placeholder glyph: a box holding the character code, or a blank 
+ * for a space.
+ *
+ */
+uint8_t lcd_putc(char c) {
+	uint8_t glyph[FONT_WIDTH] = {0x7F, 0x41, (uint8_t)c >> 1, 0x41, 0x7F, 0x00};
+	uint8_t i;
+	for (i = 0; i < FONT_WIDTH; i++) {
+		lcd_data(c == ' ' ? 0x00 : glyph[i]);
+	}
+	return FONT_WIDTH;
+}
+
+uint8_t lcd_putstr(char* str) {
+	uint8_t width = 0;
+	while (*str) {
+		width += lcd_putc(*str++);
+	}
+	return width;
+}
+
+void lcd_put_int(int16_t val) {
+	char text[8];
+	snprintf(text, sizeof(text), "%d", val);
+	lcd_putstr(text);
+	return;
+}
+
+void lcd_put_uint(uint16_t val) {
+	char text[8];
+	snprintf(text, sizeof(text), "%u", val);
+	lcd_putstr(text);
+	return;
+}
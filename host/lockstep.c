@@ -0,0 +1,483 @@
+/*************************************************************************
+Title: Lockstep Engine
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	Plays many solo games of snake on the host at once, for tuning runs
+	far longer than the console, or the emulated console, could play. The
+	games advance in lockstep: each lane of the engine is a game, and each
+	part of a tick is done for every lane before the next part, along
+	arrays over the lanes, so the compiler can turn the steps into wide
+	vector operations across games.
+
+	The rules are those of step_snake_game(), and are checked against it
+	by host/snake_lockstep.c, which plays the same games on the console's
+	own code. Instead of a linked list of segments and a walls buffer
+	caching FRAM, each lane keeps:
+
+	  - the world as a bitboard, a column_t per world column with a bit
+	    per row, set where there is a wall or a snake. The level is tiled
+	    over every screen of the world, as store_world() does.
+	  - the snake's cells, from tail to head, in a ring of LOCKSTEP_RING.
+	  - the view, which follows the head as follow() does. Food is only
+	    placed in view, in the same order as find_cell() searches the
+	    walls buffer, and with the same generator, see seed_food().
+	  - if cache_views is set, a walls buffer caching the view, laid out
+	    as the console's, which is kept up to date cell by cell and by a
+	    column or row per scroll, just as the console does. Nothing in the
+	    engine reads it; it is there for a lane to be looked at as the
+	    console sees it, e.g. by a policy, see snake_environment.c. It is
+	    left off by default, as scrolling is most of its cost, and the
+	    view scrolls on most ticks.
+
+	A tick looks up the cell each head moves into once, as enter_cell()
+	does; a head collision is a single bit test. The free cells of the
+	view are counted a column at a time, by masking it to the rows in
+	view and counting bits.
+
+	Only the solo game is played: one snake per lane, steered by arrow
+	presses. The board holds no food but the snake's own, and levels hold
+	nothing but walls, so any cell of a level that is not EMPTY is solid.
+
+*************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "lockstep.h"
+#include "world.h"
+
+#define VIEW_ROWS		(((column_t)1 << MAX_SNAKE_ROW) - 1)
+#define WORLD_MASK		((WORLD_ROWS == 64) ? ~(column_t)0 : ((column_t)1 << WORLD_ROWS) - 1)
+
+static column_t view_rows(int8_t view_y);
+static uint8_t fold_rows(column_t rows, uint16_t* slot_rows);
+static int8_t slot_column(int8_t view_x, uint8_t slot);
+static void place_food(lockstep_t* games, uint8_t lane);
+static bool in_lane_view(const lockstep_t* games, uint8_t lane, int8_t x, int8_t y);
+static void cache_lane_cell(lockstep_t* games, uint8_t lane, int8_t x, int8_t y, obj_t object);
+static void load_lane_column(lockstep_t* games, uint8_t lane, int8_t x);
+static void load_lane_row(lockstep_t* games, uint8_t lane, int8_t y);
+
+
+/*
+ * Function:  lockstep_create
+ * ---------------------------
+ * Allocates an engine for a level. Every lane is left over, until it is
+ * started with lockstep_start().
+ *
+ *  level: A walls buffer holding nothing but the level, e.g. after load_level().
+ *
+ *  returns: The engine, or NULL if there is not the memory for it.
+ *
+ */
+lockstep_t* lockstep_create(const byte level[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE]) {
+	lockstep_t* games = calloc(1, sizeof(lockstep_t));
+	uint8_t x, y, row;
+
+	if (games == NULL) return NULL;
+	for (x = 0; x < WORLD_COLUMNS; x++) {
+		for (y = 0; y < WORLD_ROWS; y++) {
+			row = y % MAX_SNAKE_ROW;
+			if ((level[x % MAX_SNAKE_COLUMN][row / SNAKE_ROWS_PER_PAGE] >>
+				 (SNAKE_ROW_BIT_SIZE*(row % SNAKE_ROWS_PER_PAGE))) & 0b11) {
+				games->level[x] |= LANE_BIT(y);
+			}
+		}
+	}
+	for (x = 0; x < LOCKSTEP_LANES; x++) {
+		games->status[x] = LANE_CRASHED;
+	}
+	return games;
+}
+
+void lockstep_destroy(lockstep_t* games) {
+	free(games);
+	return;
+}
+
+
+/*
+ * Function:  lockstep_start
+ * --------------------------
+ * Starts a new game in a lane, as place_snakes() does for the first player
+ * after the level has been loaded. The last arrow pressed is kept, just as
+ * the console keeps it from one game to the next.
+ *
+ *  lane: The game to start.
+ *  seed: Seeds the food, as seed_food() does.
+ *
+ */
+void lockstep_start(lockstep_t* games, uint8_t lane, uint16_t seed) {
+	uint8_t x;
+
+	for (x = 0; x < WORLD_COLUMNS; x++) {
+		games->solid[x][lane] = games->level[x];
+	}
+	games->view_x[lane] = 0;
+	games->view_y[lane] = 0;
+	games->tail[lane] = 0;
+	games->length[lane] = 1;
+	games->max_length[lane] = START_LENGTH;
+	games->head_x[lane] = games->body_x[0][lane] = START_X;
+	games->head_y[lane] = games->body_y[0][lane] = START_Y;
+	games->solid[START_X][lane] |= LANE_BIT(START_Y);
+	games->dir[lane] = RIGHT;
+	games->random[lane] = (seed == 0) ? 1 : seed;
+	games->status[lane] = LANE_PLAYING;
+	games->ate[lane] = FALSE;
+	place_food(games, lane);
+
+	if (!games->cache_views) return;
+	memset(games->walls[lane], OFF, sizeof(games->walls[lane]));
+	for (x = 0; x < MAX_SNAKE_COLUMN; x++) {
+		load_lane_column(games, lane, x);
+	}
+	return;
+}
+
+
+/*
+ * Function:  lockstep_step
+ * -------------------------
+ * Advances every game still being played by a tick, in the order of
+ * step_snake_game(): each head is steered and moved, and the view follows
+ * it; the head then enters its cell, crashing into anything solid or eating
+ * the food; only then is the tail cut down to the snake's length. A game is
+ * over once its snake crashes, or the view is too full for more food.
+ *
+ * Steering, moving and scrolling are done along every lane without
+ * branching, and so is the test of the cells the heads move into, so they
+ * vectorise, the test with a gather of a column per lane. The rest is done
+ * lane by lane: only a few lanes eat on any tick, and the tail is cut a
+ * cell at a time.
+ *
+ *  presses: The arrow pressed in each lane since the last tick, or NONE.
+ *
+ *  returns: The number of games still being played.
+ *
+ */
+uint8_t lockstep_step(lockstep_t* games, const direction_t presses[]) {
+	const column_t* solid = &games->solid[0][0];
+	int8_t next_x[LOCKSTEP_LANES], next_y[LOCKSTEP_LANES];
+	int8_t scroll_x[LOCKSTEP_LANES], scroll_y[LOCKSTEP_LANES];
+	bool hit[LOCKSTEP_LANES];
+	uint16_t index;
+	uint8_t lane, playing = 0;
+	int8_t x, y;
+
+	// Steer and move each head, and scroll its view
+	for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+		bool live = games->status[lane] == LANE_PLAYING;
+		direction_t pressed = presses[lane];
+		direction_t dir = games->dir[lane];
+		int8_t x = games->head_x[lane], y = games->head_y[lane];
+		int8_t view_x = games->view_x[lane], view_y = games->view_y[lane];
+		int8_t on_x = STEP_ON(x, WORLD_COLUMNS), back_x = STEP_BACK(x, WORLD_COLUMNS);
+		int8_t on_y = STEP_ON(y, WORLD_ROWS), back_y = STEP_BACK(y, WORLD_ROWS);
+		int8_t offset_x, offset_y;
+		bool follow, right, left, down, up;
+		point_t next;
+
+		// Each pick is a chain of two-way selects, which the vectoriser can if-convert
+		dir = (live & (pressed != NONE) & (pressed != OPPOSITE(dir))) ? pressed : dir;
+		next.x = (dir == RIGHT) ? on_x : x;
+		next.x = (dir == LEFT) ? back_x : next.x;
+		next.y = (dir == DOWN) ? on_y : y;
+		next.y = (dir == UP) ? back_y : next.y;
+
+		// A head moves a cell per tick, so follow() scrolls by one at most
+		offset_x = next.x - view_x + ((next.x < view_x) ? WORLD_COLUMNS : 0) - MAX_SNAKE_COLUMN/2;
+		offset_x -= (offset_x >= WORLD_COLUMNS/2) ? WORLD_COLUMNS : 0;
+		offset_y = next.y - view_y + ((next.y < view_y) ? WORLD_ROWS : 0) - MAX_SNAKE_ROW/2;
+		offset_y -= (offset_y >= WORLD_ROWS/2) ? WORLD_ROWS : 0;
+		follow = live & !OFF_WORLD(next);
+		right = follow & (offset_x > SCROLL_SLACK_X) & CAN_SCROLL(view_x, 1, MAX_SNAKE_COLUMN, WORLD_COLUMNS);
+		left = follow & (offset_x < -SCROLL_SLACK_X) & CAN_SCROLL(view_x, -1, MAX_SNAKE_COLUMN, WORLD_COLUMNS);
+		down = follow & (offset_y > SCROLL_SLACK_Y) & CAN_SCROLL(view_y, 1, MAX_SNAKE_ROW, WORLD_ROWS);
+		up = follow & (offset_y < -SCROLL_SLACK_Y) & CAN_SCROLL(view_y, -1, MAX_SNAKE_ROW, WORLD_ROWS);
+
+		games->dir[lane] = dir;
+		on_x = STEP_ON(view_x, WORLD_COLUMNS);
+		back_x = STEP_BACK(view_x, WORLD_COLUMNS);
+		on_y = STEP_ON(view_y, WORLD_ROWS);
+		back_y = STEP_BACK(view_y, WORLD_ROWS);
+		view_x = right ? on_x : view_x;
+		view_y = down ? on_y : view_y;
+		games->view_x[lane] = left ? back_x : view_x;
+		games->view_y[lane] = up ? back_y : view_y;
+		next_x[lane] = next.x;
+		next_y[lane] = next.y;
+		scroll_x[lane] = right - left;
+		scroll_y[lane] = down - up;
+	}
+
+	// Test each head's cell, with a single bit gathered from the lane's world
+	for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+		point_t next = {next_x[lane], next_y[lane]};
+		bool off = OFF_WORLD(next);
+		long x = off ? 0 : next.x;
+		int8_t y = off ? 0 : next.y;
+
+		hit[lane] = off | ((solid[x*LOCKSTEP_LANES + lane] >> y) & 1);
+	}
+
+	for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+		games->ate[lane] = FALSE;
+		if (games->status[lane] != LANE_PLAYING) continue;
+
+		// The view has already moved, and the cells that came into it are cached
+		if (scroll_x[lane] != 0 && games->cache_views) {
+			x = games->view_x[lane];
+			if (scroll_x[lane] > 0) x = (x + MAX_SNAKE_COLUMN - 1) % WORLD_COLUMNS;
+			load_lane_column(games, lane, x);
+		}
+		if (scroll_y[lane] != 0 && games->cache_views) {
+			y = games->view_y[lane];
+			if (scroll_y[lane] > 0) y = (y + MAX_SNAKE_ROW - 1) % WORLD_ROWS;
+			load_lane_row(games, lane, y);
+		}
+
+		x = next_x[lane];
+		y = next_y[lane];
+		if (hit[lane]) {
+			games->status[lane] = LANE_CRASHED;
+		} else {
+			games->solid[(uint8_t)x][lane] |= LANE_BIT(y);
+			cache_lane_cell(games, lane, x, y, WALL);
+		}
+		index = games->tail[lane] + games->length[lane];
+		if (index >= LOCKSTEP_RING) index -= LOCKSTEP_RING;
+		games->body_x[index][lane] = games->head_x[lane] = x;
+		games->body_y[index][lane] = games->head_y[lane] = y;
+		games->length[lane]++;
+		if (games->status[lane] != LANE_PLAYING) continue;
+
+		if (x == games->food_x[lane] && y == games->food_y[lane]) {
+			games->ate[lane] = TRUE;
+			games->max_length[lane] = GROW(games->max_length[lane]);
+			place_food(games, lane);
+		}
+		if (games->food_x[lane] < 0) {
+			games->status[lane] = LANE_WON;
+			continue;
+		}
+		while (games->length[lane] >= games->max_length[lane]) {
+			index = games->tail[lane]++;
+			if (games->tail[lane] == LOCKSTEP_RING) games->tail[lane] = 0;
+			x = games->body_x[index][lane];
+			y = games->body_y[index][lane];
+			games->solid[(uint8_t)x][lane] &= ~LANE_BIT(y);
+			cache_lane_cell(games, lane, x, y, EMPTY);
+			games->length[lane]--;
+		}
+		playing++;
+	}
+	return playing;
+}
+
+
+/*
+ * Function:  lockstep_cell
+ * -------------------------
+ *  returns: What a cell of the world holds in a lane. Snakes are walls, just
+ *           as they are on the console.
+ *
+ */
+obj_t lockstep_cell(const lockstep_t* games, uint8_t lane, point_t pt) {
+	if (games->solid[(uint8_t)pt.x][lane] & LANE_BIT(pt.y)) return WALL;
+	if (pt.x == games->food_x[lane] && pt.y == games->food_y[lane]) return FOOD;
+	return EMPTY;
+}
+
+
+/*
+ * Function:  lockstep_free_cells
+ * -------------------------------
+ * Counts the free cells in view, as count_cells(EMPTY) does on the console,
+ * a column at a time. The food is not counted.
+ *
+ */
+uint16_t lockstep_free_cells(const lockstep_t* games, uint8_t lane) {
+	column_t rows = view_rows(games->view_y[lane]);
+	uint16_t count = 0;
+	uint8_t slot;
+	point_t food = {games->food_x[lane], games->food_y[lane]};
+
+	for (slot = 0; slot < MAX_SNAKE_COLUMN; slot++) {
+		count += __builtin_popcountll(~games->solid[(uint8_t)slot_column(games->view_x[lane], slot)][lane] & rows);
+	}
+	return (food.x >= 0 && (rows & LANE_BIT(food.y))) ? count - 1 : count;
+}
+
+
+/*
+ * Function:  view_rows
+ * ---------------------
+ *  returns: The bits of the rows in view, which wrap around the bottom of the
+ *           world.
+ *
+ */
+static column_t view_rows(int8_t view_y) {
+	column_t rows = VIEW_ROWS << view_y;
+	if (view_y + MAX_SNAKE_ROW > WORLD_ROWS) rows |= VIEW_ROWS >> (WORLD_ROWS - view_y);
+	return rows & WORLD_MASK;
+}
+
+
+/*
+ * Function:  fold_rows
+ * ---------------------
+ * Folds the rows in view of a column onto the rows of its slot in the walls
+ * buffer, row y landing on y % MAX_SNAKE_ROW. The view holds one world row of
+ * each slot row, so no two bits land on the same row.
+ *
+ *  slot_rows: Set to a bit per slot row.
+ *
+ *  returns: The number of bits set.
+ *
+ */
+static uint8_t fold_rows(column_t rows, uint16_t* slot_rows) {
+	uint8_t screen;
+
+	*slot_rows = 0;
+	for (screen = 0; screen < WORLD_SCREENS_Y; screen++) {
+		*slot_rows |= (rows >> (screen*MAX_SNAKE_ROW)) & VIEW_ROWS;
+	}
+	return __builtin_popcount(*slot_rows);
+}
+
+
+/*
+ * Function:  slot_column
+ * -----------------------
+ *  returns: The world column cached in a column slot of the walls buffer, as
+ *           cached_point() finds it.
+ *
+ */
+static int8_t slot_column(int8_t view_x, uint8_t slot) {
+	int8_t dx = slot - view_x % MAX_SNAKE_COLUMN;
+	int8_t x = view_x + ((dx < 0) ? dx + MAX_SNAKE_COLUMN : dx);
+	return (x >= WORLD_COLUMNS) ? x - WORLD_COLUMNS : x;
+}
+
+
+/*
+ * Function:  place_food
+ * ----------------------
+ * Places the food on a free cell in view, as generate_food() does: the free
+ * cells are counted, and the n-th picked at random, counting down each slot
+ * column of the walls buffer in turn. Rows in view are folded onto their
+ * slot rows, so the bits of a column are in the same order as its cells in
+ * the walls buffer. If the view is full, the food is left off the world.
+ *
+ */
+static void place_food(lockstep_t* games, uint8_t lane) {
+	column_t rows = view_rows(games->view_y[lane]);
+	uint16_t free_cells = 0, n, slot_rows;
+	uint8_t slot, row, count;
+	int8_t x, dy;
+
+	for (slot = 0; slot < MAX_SNAKE_COLUMN; slot++) {
+		free_cells += __builtin_popcountll(~games->solid[(uint8_t)slot_column(games->view_x[lane], slot)][lane] & rows);
+	}
+	games->food_x[lane] = games->food_y[lane] = -1;
+	if (free_cells == 0) return;
+
+	n = next_random(&games->random[lane]) % free_cells;
+	for (slot = 0; slot < MAX_SNAKE_COLUMN; slot++) {
+		x = slot_column(games->view_x[lane], slot);
+		count = fold_rows(~games->solid[(uint8_t)x][lane] & rows, &slot_rows);
+		if (n >= count) {
+			n -= count;
+			continue;
+		}
+		for (row = 0; ; row++, slot_rows >>= 1) {
+			if ((slot_rows & 0x01) && n-- == 0) break;
+		}
+		dy = row - games->view_y[lane] % MAX_SNAKE_ROW;
+		dy = games->view_y[lane] + ((dy < 0) ? dy + MAX_SNAKE_ROW : dy);
+		games->food_x[lane] = x;
+		games->food_y[lane] = (dy >= WORLD_ROWS) ? dy - WORLD_ROWS : dy;
+		cache_lane_cell(games, lane, x, games->food_y[lane], FOOD);
+		return;
+	}
+}
+
+
+/*
+ * Function:  in_lane_view
+ * ------------------------
+ *  returns: True, if a world cell is in a lane's view, as in_view() finds.
+ *
+ */
+static bool in_lane_view(const lockstep_t* games, uint8_t lane, int8_t x, int8_t y) {
+	int8_t dx = x - games->view_x[lane], dy = y - games->view_y[lane];
+
+	if (dx < 0) dx += WORLD_COLUMNS;
+	if (dy < 0) dy += WORLD_ROWS;
+	return dx < MAX_SNAKE_COLUMN && dy < MAX_SNAKE_ROW;
+}
+
+
+/*
+ * Function:  cache_lane_cell
+ * ---------------------------
+ * Stores an object in the slot of a lane's walls buffer caching a world cell,
+ * as cache_cell() does, if the cell is in view.
+ *
+ */
+static void cache_lane_cell(lockstep_t* games, uint8_t lane, int8_t x, int8_t y, obj_t object) {
+	uint8_t row = y % MAX_SNAKE_ROW, shift = SNAKE_ROW_BIT_SIZE*(row % SNAKE_ROWS_PER_PAGE);
+	byte* cached = &games->walls[lane][x % MAX_SNAKE_COLUMN][row / SNAKE_ROWS_PER_PAGE];
+
+	if (!games->cache_views || !in_lane_view(games, lane, x, y)) return;
+	SET(*cached, (0b11 << shift), (object << shift));
+	return;
+}
+
+
+/*
+ * Function:  load_lane_column
+ * ----------------------------
+ * Caches the rows in view of a world column in a lane's walls buffer, as 
+ * load_world_column() does from FRAM, a byte at a time: the walls are folded
+ * onto their slot rows, and each bit spread out to the two of its cell.
+ *
+ */
+static void load_lane_column(lockstep_t* games, uint8_t lane, int8_t x) {
+	column_t rows = view_rows(games->view_y[lane]);
+	uint16_t slot_rows;
+	uint32_t cells;
+	uint8_t page;
+
+	fold_rows(games->solid[(uint8_t)x][lane] & rows, &slot_rows);
+	cells = slot_rows;
+	cells = (cells | (cells << 8)) & 0x00FF00FF;
+	cells = (cells | (cells << 4)) & 0x0F0F0F0F;
+	cells = (cells | (cells << 2)) & 0x33333333;
+	cells = (cells | (cells << 1)) & 0x55555555;	// WALL in each cell with a wall
+	if (x == games->food_x[lane] && (rows & LANE_BIT(games->food_y[lane]))) {
+		cells |= (uint32_t)FOOD << (SNAKE_ROW_BIT_SIZE*(games->food_y[lane] % MAX_SNAKE_ROW));
+	}
+	for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+		games->walls[lane][x % MAX_SNAKE_COLUMN][page] = cells >> (page*BIT_PER_BYTE);
+	}
+	return;
+}
+
+static void load_lane_row(lockstep_t* games, uint8_t lane, int8_t y) {
+	uint8_t row = y % MAX_SNAKE_ROW, shift = SNAKE_ROW_BIT_SIZE*(row % SNAKE_ROWS_PER_PAGE);
+	uint8_t slot;
+	int8_t x;
+	obj_t object;
+
+	for (slot = 0; slot < MAX_SNAKE_COLUMN; slot++) {
+		x = slot_column(games->view_x[lane], slot);
+		object = (games->solid[(uint8_t)x][lane] & LANE_BIT(y)) ? WALL : EMPTY;
+		if (x == games->food_x[lane] && y == games->food_y[lane]) object = FOOD;
+		SET(games->walls[lane][slot][row / SNAKE_ROWS_PER_PAGE], (0b11 << shift), (object << shift));
+	}
+	return;
+}
@@ -0,0 +1,66 @@
+/*************************************************************************
+Title:    Lockstep Engine Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	Plays many solo games of snake side by side, one per lane, each tick
+	of every game at once. See lockstep.c.
+
+*************************************************************************/
+
+#ifndef _LOCKSTEP_H_
+#define _LOCKSTEP_H_
+
+#include <stdint.h>
+#include "console.h"
+#include "snake.h"
+
+#ifndef LOCKSTEP_LANES
+#define LOCKSTEP_LANES		64	// Games stepped together
+#endif
+#define LOCKSTEP_RING		(WORLD_COLUMNS*WORLD_ROWS)	// Cells of a snake's body, which can never outgrow the world
+
+#if WORLD_ROWS > 64
+#error "A column of the world must fit in a column_t"
+#endif
+
+typedef uint64_t column_t;	// A column of the world, one bit per row
+
+typedef enum {LANE_PLAYING, LANE_CRASHED, LANE_WON} lane_status_t;
+
+// Every field is an array over the lanes, so each step works along a lane row. 
+// Only the walls buffer is kept whole for each lane, for a lane to read it as is.
+typedef struct {
+	column_t level[WORLD_COLUMNS];						// Walls of the level, the same in every lane
+	column_t solid[WORLD_COLUMNS][LOCKSTEP_LANES];		// Walls and snakes
+	int8_t body_x[LOCKSTEP_RING][LOCKSTEP_LANES];		// The snake, from tail to head
+	int8_t body_y[LOCKSTEP_RING][LOCKSTEP_LANES];
+	uint16_t tail[LOCKSTEP_LANES];						// Index of the tail in the ring
+	uint16_t length[LOCKSTEP_LANES];
+	uint16_t max_length[LOCKSTEP_LANES];
+	int8_t head_x[LOCKSTEP_LANES], head_y[LOCKSTEP_LANES];
+	int8_t food_x[LOCKSTEP_LANES], food_y[LOCKSTEP_LANES];
+	int8_t view_x[LOCKSTEP_LANES], view_y[LOCKSTEP_LANES];
+	direction_t dir[LOCKSTEP_LANES];
+	uint16_t random[LOCKSTEP_LANES];					// Food generator, see seed_food()
+	lane_status_t status[LOCKSTEP_LANES];
+	bool ate[LOCKSTEP_LANES];							// On the last tick
+	bool cache_views;									// Whether walls is kept, set before starting
+	byte walls[LOCKSTEP_LANES][MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE];	// Each view, cached as the console caches it
+} lockstep_t;
+
+// Lockstep function declarations
+lockstep_t*	lockstep_create(const byte level[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE]);
+void 		lockstep_destroy(lockstep_t* games);
+void 		lockstep_start(lockstep_t* games, uint8_t lane, uint16_t seed);
+uint8_t 	lockstep_step(lockstep_t* games, const direction_t presses[]);
+obj_t 		lockstep_cell(const lockstep_t* games, uint8_t lane, point_t pt);
+uint16_t 	lockstep_free_cells(const lockstep_t* games, uint8_t lane);
+
+//Lockstep Interface
+#define LANE_BIT(ROW)		((column_t)1 << (ROW))	// The bit of a row in a column_t
+
+/*** End of Lockstep Engine Header File ****/
+#endif
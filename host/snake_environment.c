@@ -0,0 +1,268 @@
+/*************************************************************************
+Title: Snake Environment
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	Plays batches of games through the environment, see environment.c, as
+	a learning program would, and reports the steps per second of a single
+	core. Each game is played by a policy reading its observation: it turns
+	at random every few steps, as the scripted player does, and away from
+	anything solid in the cell ahead, read from the game's walls buffer. A
+	game is reset on the step after it is done.
+
+	With -c, every game of a batch is then played from a seed, and played
+	again from the same seed with the same actions after games that ended
+	pressing another arrow. The two must match step by step, as a reset
+	game depends only on its seed.
+
+	usage: snake_environment [-s seed] [-t steps] [-l level] [-b batches] [-c]
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "console.h"
+#include "snake.h"
+#include "bench.h"
+#include "level.h"
+#include "environment.h"
+
+typedef struct {
+	point_t head;
+	point_t food;
+	bool done;
+} env_trace_t;
+
+typedef struct {
+	unsigned episodes;
+	unsigned food;
+	unsigned crashes;
+} tally_t;
+
+
+/*
+ * Function:  choose_action
+ * -------------------------
+ * Policy of a game, from its observation and its own generator.
+ *
+ */
+static direction_t choose_action(const environment_t* env, uint8_t index, uint16_t* random) {
+	point_t head = ENV_HEAD(env, index);
+	direction_t dir = ENV_DIRECTION(env, index);
+	int8_t turn = (next_random(random) & 0x01) ? TURN_RIGHT : TURN_LEFT;
+	bool blocked = environment_cell(env, index, next_pos(head, dir)) == WALL;
+
+	if (!blocked && next_random(random) % TURN_CHANCE != 0) return NONE;
+	if (environment_cell(env, index, next_pos(head, turn_direction(dir, turn))) != WALL) {
+		return turn_direction(dir, turn);
+	}
+	return blocked ? turn_direction(dir, -turn) : NONE;
+}
+
+static double cpu_seconds(void) {
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+
+/*
+ * Function:  play_batches
+ * ------------------------
+ * Steps each batch in turn, for a number of steps.
+ *
+ *  seconds: Set to the time taken.
+ *
+ */
+static void play_batches(environment_t* envs[], unsigned batches, unsigned seed, unsigned steps,
+						 tally_t* tally, double* seconds) {
+	uint16_t randoms[batches][ENVIRONMENTS];
+	direction_t actions[ENVIRONMENTS];
+	unsigned batch, step;
+	uint8_t index;
+	environment_t* env;
+	double start = cpu_seconds();
+
+	for (batch = 0; batch < batches; batch++) {
+		for (index = 0; index < ENVIRONMENTS; index++) {
+			randoms[batch][index] = (seed*batches + batch)*ENVIRONMENTS + index + 1;
+		}
+	}
+	for (step = 0; step < steps; step++) {
+		for (batch = 0; batch < batches; batch++) {
+			env = envs[batch];
+			for (index = 0; index < ENVIRONMENTS; index++) {
+				if (env->done[index]) {
+					environment_reset(env, index, next_random(&randoms[batch][index]));
+					tally->episodes++;
+				}
+				actions[index] = choose_action(env, index, &randoms[batch][index]);
+			}
+			environment_step(env, actions);
+			for (index = 0; index < ENVIRONMENTS; index++) {
+				tally->food += env->reward[index] == REWARD_FOOD;
+				tally->crashes += env->reward[index] == REWARD_CRASH;
+			}
+		}
+	}
+	*seconds = cpu_seconds() - start;
+	return;
+}
+
+
+/*
+ * Function:  keep_step
+ * ---------------------
+ * Keeps each game's head, food and whether it is done, after a step.
+ *
+ */
+static void keep_step(const environment_t* env, env_trace_t row[]) {
+	uint8_t index;
+
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		memset(&row[index], 0, sizeof(env_trace_t));
+		row[index].head = ENV_HEAD(env, index);
+		row[index].food = ENV_FOOD(env, index);
+		row[index].done = env->done[index];
+	}
+	return;
+}
+
+
+/*
+ * Function:  check_resets
+ * ------------------------
+ * Plays every game of a fresh batch from a seed with the policy's actions,
+ * then other games ending with an arrow pressed, and then the first games
+ * again from the same seeds and with the same actions.
+ *
+ *  returns: True, if both plays of every game matched.
+ *
+ */
+static bool check_resets(environment_t* env, unsigned seed, unsigned steps) {
+	uint16_t seeds[ENVIRONMENTS], randoms[ENVIRONMENTS];
+	direction_t (*actions)[ENVIRONMENTS] = calloc(steps, sizeof(*actions));
+	env_trace_t (*first)[ENVIRONMENTS] = calloc(steps, sizeof(*first));
+	env_trace_t (*again)[ENVIRONMENTS] = calloc(steps, sizeof(*again));
+	direction_t pressed[ENVIRONMENTS];
+	unsigned step;
+	uint8_t index;
+	bool passed = TRUE;
+
+	if (actions == NULL || first == NULL || again == NULL) {
+		perror("trace");
+		exit(2);
+	}
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		seeds[index] = seed*ENVIRONMENTS + index + 1;
+		randoms[index] = seeds[index];
+	}
+
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		environment_reset(env, index, seeds[index]);
+	}
+	for (step = 0; step < steps; step++) {
+		for (index = 0; index < ENVIRONMENTS; index++) {
+			actions[step][index] = choose_action(env, index, &randoms[index]);
+		}
+		environment_step(env, actions[step]);
+		keep_step(env, first[step]);
+	}
+
+	// Other games, left with a different arrow pressed in each
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		environment_reset(env, index, ~seeds[index]);
+		pressed[index] = (direction_t)(index % 4);
+	}
+	environment_step(env, pressed);
+
+	for (index = 0; index < ENVIRONMENTS; index++) {
+		environment_reset(env, index, seeds[index]);
+	}
+	for (step = 0; step < steps; step++) {
+		environment_step(env, actions[step]);
+		keep_step(env, again[step]);
+	}
+	for (step = 0; step < steps && passed; step++) {
+		for (index = 0; index < ENVIRONMENTS && passed; index++) {
+			if (memcmp(&first[step][index], &again[step][index], sizeof(env_trace_t)) != 0) {
+				fprintf(stderr, "game %u step %u: head (%d,%d)/(%d,%d) food (%d,%d)/(%d,%d) done %d/%d\n",
+					index, step, first[step][index].head.x, first[step][index].head.y,
+					again[step][index].head.x, again[step][index].head.y,
+					first[step][index].food.x, first[step][index].food.y,
+					again[step][index].food.x, again[step][index].food.y,
+					first[step][index].done, again[step][index].done);
+				passed = FALSE;
+			}
+		}
+	}
+	free(actions);
+	free(first);
+	free(again);
+	return passed;
+}
+
+int main(int argc, char** argv) {
+	unsigned seed = 1, steps = 2000, level = 0, batches = 4, batch;
+	byte level_walls[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE];
+	environment_t** envs;
+	environment_t* env;
+	tally_t tally = {0, 0, 0};
+	double seconds;
+	bool check = FALSE, passed;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:t:l:b:c")) != -1) {
+		switch (opt) {
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 't': steps = strtoul(optarg, NULL, 0); break;
+			case 'l': level = strtoul(optarg, NULL, 0) % LEVEL_COUNT; break;
+			case 'b': batches = strtoul(optarg, NULL, 0); break;
+			case 'c': check = TRUE; break;
+			default:
+				fprintf(stderr, "usage: %s [-s seed] [-t steps] [-l level] [-b batches] [-c]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (steps == 0 || batches == 0) return 2;
+
+	initialise_game_console();
+	srand(seed);
+	load_level(level);
+	memcpy(level_walls, (const byte*)walls, sizeof(level_walls));
+
+	envs = calloc(batches, sizeof(environment_t*));
+	for (batch = 0; envs != NULL && batch < batches; batch++) {
+		envs[batch] = environment_create(level_walls);
+		if (envs[batch] == NULL) break;
+	}
+	if (envs == NULL || batch < batches) {
+		perror("environment");
+		return 2;
+	}
+
+	play_batches(envs, batches, seed, steps, &tally, &seconds);
+	printf("environments,steps,episodes,food,crashes,steps_per_s\n");
+	printf("%u,%u,%u,%u,%u,%.0f\n", batches*ENVIRONMENTS, steps, tally.episodes, tally.food,
+		tally.crashes, (double)batches*ENVIRONMENTS*steps/seconds);
+
+	for (batch = 0; batch < batches; batch++) {
+		environment_destroy(envs[batch]);
+	}
+	free(envs);
+	if (!check) return 0;
+
+	env = environment_create(level_walls);
+	if (env == NULL) {
+		perror("environment");
+		return 2;
+	}
+	passed = check_resets(env, seed, steps);
+	environment_destroy(env);
+	fprintf(stderr, "%s\n",
+		passed ? "resets depend only on the seed" : "resets depend on the game before");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,527 @@
+/*************************************************************************
+Title: Snake Fuzz
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	Searches for the presses that make a tick of the solo game slowest. A
+	scenario is a seed, a level, and the arrow pressed on each tick, and
+	is played from the start of a game until it ends or runs out of ticks.
+	Its cost is the cost of its slowest tick.
+
+	The game's code is built for this tool with -fsanitize-coverage=trace-pc,
+	so every basic block it runs calls __sanitizer_cov_trace_pc(). A tick
+	costs the blocks it runs, plus one for each byte it sends over SPI, for
+	the loop that sends it. Unlike the host's clock, the count is the same
+	on every run. The edges between blocks are also hashed into a map, as
+	AFL does, to tell when a scenario reaches new code, or runs the same
+	code a new number of times.
+
+	Every scenario is played in a child forked from the console as it is
+	after power-up, so nothing is carried over from the runs before it,
+	and the FRAM is kept in memory only. A scenario costs the same from one
+	run, and one process, to the next. One that crashes the game is saved
+	as it is, with a cost of zero.
+
+	Scenarios are bred from a corpus. The seed or level is changed, presses
+	are made or cleared, a burst of rapid turns is written in, or a run of
+	presses is spliced in from another scenario. A mutant is kept if it is
+	costlier than the worst so far, or covers something new. The costliest
+	is then minimised: it is cut off after its slowest tick, and every
+	press is cleared that the cost does not depend on. It is then saved.
+
+	With -r, saved scenarios are replayed as regression benchmarks. Each
+	fails if its cost has grown by more than FUZZ_TOLERANCE percent over
+	the cost it was saved with, or if it crashes. The clock's time of the
+	slowest tick is printed alongside, in cycles of F_CPU.
+
+	usage: snake_fuzz [-s seed] [-n runs] [-t ticks] [-o scenario.txt]
+	       snake_fuzz -r scenario.txt ...
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "console.h"
+#include "snake.h"
+#include "bench.h"
+#include "level.h"
+#include "module.h"
+#include "fram.h"
+
+#define FUZZ_MAX_TICKS		2000	// Longest scenario
+#define FUZZ_CORPUS			64		// Scenarios bred from
+#define FUZZ_MAP_BITS		16		// Edges hashed into 2^16 counters
+#define FUZZ_MAP			(1UL << FUZZ_MAP_BITS)
+#define FUZZ_MUTATIONS		4		// Most mutations per mutant
+#define FUZZ_BURST			12		// Most ticks of rapid turning
+#define FUZZ_TOLERANCE		10		// Percent a replayed cost may grow by
+#define SCENARIO_LINE		64		// Presses per line of a saved scenario
+
+
+typedef struct {
+	uint16_t seed;
+	uint8_t level;
+	uint16_t ticks;
+	direction_t presses[FUZZ_MAX_TICKS];
+} scenario_t;
+
+typedef struct {
+	uint32_t cost;		// Of the slowest tick
+	uint32_t cycles;	// Clocked during it
+	uint16_t tick;		// Which tick it was
+	uint16_t played;	// Ticks played before the game ended
+	bool crashed;		// The game never came back from a tick
+} result_t;
+
+typedef struct {
+	uint8_t edges[FUZZ_MAP];	// Hit counts of the run
+	result_t result;
+} run_t;	// Shared with the child playing a run
+
+static const char press_names[] = "UDLR.";	// In the order of direction_t
+
+static uint16_t fuzz_random = 1;	// Kept apart from rand(), which each run reseeds
+static uint32_t blocks = 0;
+static uintptr_t last_block = 0;
+static uint8_t* edges = NULL;		// Set in the child only
+static run_t* run = NULL;
+static uint8_t covered[FUZZ_MAP];	// Every bucket of hits seen, one bit each
+
+
+/*
+ * Function:  __sanitizer_cov_trace_pc
+ * ------------------------------------
+ * Called by the compiler at the start of every basic block of the game.
+ * Counts the block, and the edge to it from the last.
+ *
+ */
+void __sanitizer_cov_trace_pc(void) {
+	uintptr_t block = (uintptr_t)__builtin_return_address(0);
+
+	blocks++;
+	if (edges == NULL) return;
+	edges[(block ^ last_block) & (FUZZ_MAP - 1)]++;
+	last_block = block >> 1;
+	return;
+}
+
+
+/*
+ * Function:  hit_bucket
+ * ----------------------
+ *  returns: A bit for the bucket of a hit count, as AFL buckets them, so
+ *           running an edge a few more times is not new, but twice as often is.
+ *
+ */
+static uint8_t hit_bucket(uint8_t hits) {
+	if (hits == 0) return 0;
+	if (hits <= 3) return 1 << (hits - 1);
+	if (hits <= 7) return 1 << 3;
+	if (hits <= 15) return 1 << 4;
+	if (hits <= 31) return 1 << 5;
+	if (hits <= 127) return 1 << 6;
+	return 1 << 7;
+}
+
+/*
+ * Function:  cover
+ * -----------------
+ * Adds the edges of the last run to those covered.
+ *
+ *  returns: True, if any edge was run a new number of times.
+ *
+ */
+static bool cover(void) {
+	uint32_t i;
+	uint8_t bucket;
+	bool new = FALSE;
+
+	for (i = 0; i < FUZZ_MAP; i++) {
+		bucket = hit_bucket(run->edges[i]);
+		if (bucket & ~covered[i]) {
+			covered[i] |= bucket;
+			new = TRUE;
+		}
+	}
+	return new;
+}
+
+
+/*
+ * Function:  play_game
+ * ---------------------
+ * Plays a scenario from the start of a new game, timing and costing each
+ * tick as run_tick() runs it, render and all. The FRAM's counters are
+ * cleared before each tick, as its operation counts would wrap.
+ *
+ *  result: Set to the slowest tick.
+ *
+ */
+static void play_game(const scenario_t* scenario, result_t* result) {
+	uint32_t cost, start, spi_bytes;
+	uint16_t tick;
+	bool alive = TRUE;
+
+	srand(scenario->seed);
+	seed_food(scenario->seed);
+	select_level(scenario->level);
+	flush_input();
+	enter_module(&solo_snake);
+
+	for (tick = 0; alive && tick < scenario->ticks; tick++) {
+		if (scenario->presses[tick] != NONE) push_input((button_t)scenario->presses[tick]);
+		fram_stats = (fram_stats_t){0};
+		spi_bytes = spi_bytes_sent();
+		blocks = 0;
+		start = get_cycles();
+		alive = run_tick(&solo_snake);
+		start = get_cycles() - start;
+		cost = blocks + (spi_bytes_sent() - spi_bytes);
+		if (cost > result->cost) {
+			result->cost = cost;
+			result->cycles = start;
+			result->tick = tick;
+		}
+		result->played = tick + 1;
+	}
+	leave_module(&solo_snake);
+	return;
+}
+
+/*
+ * Function:  play_scenario
+ * -------------------------
+ * Plays a scenario in a child of the console, see play_game(), which
+ * hands back its edges and result in shared memory.
+ *
+ *  result: Set to the slowest tick, and whether the game crashed.
+ *
+ */
+static void play_scenario(const scenario_t* scenario, result_t* result) {
+	pid_t child;
+	int status = 0;
+
+	memset(run, 0, sizeof(run_t));
+	fflush(NULL);
+	child = fork();
+	if (child == 0) {
+		edges = run->edges;
+		play_game(scenario, &run->result);
+		_exit(0);
+	}
+	if (child < 0 || waitpid(child, &status, 0) != child) {
+		perror("fork");
+		exit(2);
+	}
+	*result = run->result;
+	result->crashed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	return;
+}
+
+
+static uint16_t fuzz_rand(void) {
+	return next_random(&fuzz_random);
+}
+
+
+/*
+ * Function:  script_scenario
+ * ---------------------------
+ * Fills a scenario with presses like the scripted player's, see script_turn().
+ *
+ */
+static void script_scenario(scenario_t* scenario, uint16_t seed, uint16_t ticks) {
+	uint16_t tick;
+
+	scenario->seed = seed;
+	scenario->level = seed % LEVEL_COUNT;
+	scenario->ticks = ticks;
+	for (tick = 0; tick < ticks; tick++) {
+		scenario->presses[tick] = (fuzz_rand() % TURN_CHANCE == 0) ? fuzz_rand() % NONE : NONE;
+	}
+	return;
+}
+
+/*
+ * Function:  mutate
+ * ------------------
+ * Applies a few random mutations to a scenario.
+ *
+ *  donor: Another scenario, to splice presses from.
+ *
+ */
+static void mutate(scenario_t* scenario, const scenario_t* donor) {
+	uint8_t mutations = 1 + fuzz_rand() % FUZZ_MUTATIONS;
+	uint16_t at, length, i;
+	direction_t turn;
+
+	while (mutations--) {
+		at = fuzz_rand() % scenario->ticks;
+		length = 1 + fuzz_rand() % FUZZ_BURST;
+		if (at + length > scenario->ticks) length = scenario->ticks - at;
+		switch (fuzz_rand() % 6) {
+			case 0:
+				scenario->seed = fuzz_rand();
+				break;
+			case 1:
+				scenario->level = fuzz_rand() % LEVEL_COUNT;
+				break;
+			case 2:
+				scenario->presses[at] = fuzz_rand() % NONE;
+				break;
+			case 3:
+				memset(&scenario->presses[at], NONE, length*sizeof(direction_t));
+				break;
+			case 4:
+				// Rapid turns, which cut the snake into many short segments
+				turn = (fuzz_rand() & 0x01) ? UP : DOWN;
+				for (i = 0; i < length; i++) {
+					scenario->presses[at + i] = (i % 2 == 0) ? turn : ((fuzz_rand() & 0x01) ? LEFT : RIGHT);
+				}
+				break;
+			default:
+				if (at + length > donor->ticks) break;
+				memcpy(&scenario->presses[at], &donor->presses[at], length*sizeof(direction_t));
+				break;
+		}
+	}
+	return;
+}
+
+
+/*
+ * Function:  minimise
+ * --------------------
+ * Cuts a scenario off after its slowest tick, then clears its presses a
+ * run at a time, halving the run each pass, wherever that does not lower
+ * its cost.
+ *
+ */
+static void minimise(scenario_t* scenario, result_t* result) {
+	direction_t saved[FUZZ_MAX_TICKS];
+	uint32_t cost = result->cost;
+	uint16_t length, chunk, at, i;
+	result_t trial;
+	bool any;
+
+	scenario->ticks = result->tick + 1;
+	for (length = scenario->ticks; length > 0; length /= 2) {
+		for (at = 0; at < scenario->ticks; at += length) {
+			chunk = (at + length > scenario->ticks) ? scenario->ticks - at : length; // The last run may be short
+			for (i = at, any = FALSE; i < at + chunk; i++) {
+				any |= scenario->presses[i] != NONE;
+			}
+			if (!any) continue;
+
+			memcpy(saved, &scenario->presses[at], chunk*sizeof(direction_t));
+			memset(&scenario->presses[at], NONE, chunk*sizeof(direction_t));
+			play_scenario(scenario, &trial);
+			if (trial.cost < cost || trial.crashed) {
+				memcpy(&scenario->presses[at], saved, chunk*sizeof(direction_t));
+			}
+		}
+	}
+	play_scenario(scenario, result);
+	scenario->ticks = result->tick + 1;
+	return;
+}
+
+
+/*
+ * Function:  save_scenario
+ * -------------------------
+ * Writes a scenario out as text, with the cost it was found at: a line per
+ * field, then the presses, a character per tick from press_names.
+ *
+ */
+static void save_scenario(FILE* out, const scenario_t* scenario, const result_t* result) {
+	uint16_t tick;
+
+	fprintf(out, "# Found by snake_fuzz; replay with ./snake_fuzz -r\n");
+	fprintf(out, "seed: %u\nlevel: %u\nticks: %u\ncost: %u\npresses:\n",
+		scenario->seed, scenario->level, scenario->ticks, result->cost);
+	for (tick = 0; tick < scenario->ticks; tick++) {
+		fputc(press_names[scenario->presses[tick]], out);
+		if ((tick + 1) % SCENARIO_LINE == 0 || tick + 1 == scenario->ticks) fputc('\n', out);
+	}
+	return;
+}
+
+/*
+ * Function:  load_scenario
+ * -------------------------
+ * Reads back a scenario written by save_scenario().
+ *
+ *  cost: Set to the cost it was saved with.
+ *
+ *  returns: True, if the file held a whole scenario.
+ *
+ */
+static bool load_scenario(const char* path, scenario_t* scenario, uint32_t* cost) {
+	FILE* in = fopen(path, "r");
+	char line[SCENARIO_LINE + 16], *name;
+	unsigned value, fields = 0;
+	uint16_t tick = 0;
+
+	if (in == NULL) {
+		perror(path);
+		return FALSE;
+	}
+	memset(scenario, 0, sizeof(scenario_t));
+	while (fgets(line, sizeof(line), in) != NULL) {
+		if (line[0] == '#') continue;
+		if (fields < 4) {
+			if (sscanf(line, "seed: %u", &value) == 1) scenario->seed = value;
+			else if (sscanf(line, "level: %u", &value) == 1) scenario->level = value % LEVEL_COUNT;
+			else if (sscanf(line, "ticks: %u", &value) == 1) scenario->ticks = value;
+			else if (sscanf(line, "cost: %u", &value) == 1) *cost = value;
+			else continue;
+			fields++;
+			continue;
+		}
+		for (name = line; *name != '\0' && *name != '\n' && tick < FUZZ_MAX_TICKS; name++) {
+			if (strchr(press_names, *name) == NULL) continue;
+			scenario->presses[tick++] = strchr(press_names, *name) - press_names;
+		}
+	}
+	fclose(in);
+	return fields == 4 && scenario->ticks > 0 && tick == scenario->ticks;
+}
+
+
+/*
+ * Function:  replay
+ * ------------------
+ * Plays saved scenarios again, and checks their costs against those they
+ * were saved with.
+ *
+ *  returns: True, if none crashed or grew by more than FUZZ_TOLERANCE percent.
+ *
+ */
+static bool replay(char* const paths[], int count) {
+	static scenario_t scenario;
+	result_t result;
+	uint32_t saved = 0;
+	bool passed = TRUE, grew;
+	int i;
+
+	printf("scenario,ticks,slowest_tick,cost,saved_cost,cycles\n");
+	for (i = 0; i < count; i++) {
+		if (!load_scenario(paths[i], &scenario, &saved)) {
+			fprintf(stderr, "%s: not a scenario\n", paths[i]);
+			passed = FALSE;
+			continue;
+		}
+		play_scenario(&scenario, &result);
+		printf("%s,%u,%u,%u,%u,%u\n", paths[i], result.played, result.tick, result.cost, saved, result.cycles);
+		grew = (uint64_t)result.cost*100 > (uint64_t)saved*(100 + FUZZ_TOLERANCE);
+		if (grew) fprintf(stderr, "%s: cost grew from %u to %u\n", paths[i], saved, result.cost);
+		if (result.crashed) fprintf(stderr, "%s: crashed the game\n", paths[i]);
+		passed &= !grew && !result.crashed;
+	}
+	return passed;
+}
+
+
+/*
+ * Function:  fuzz
+ * ----------------
+ * Breeds scenarios for a number of runs, from a corpus seeded with games
+ * of the scripted player, and minimises the costliest. Stops at the first
+ * scenario that crashes the game.
+ *
+ *  best: Set to the costliest scenario, or the one that crashed.
+ *
+ */
+static void fuzz(unsigned runs, uint16_t ticks, scenario_t* best, result_t* worst) {
+	static scenario_t corpus[FUZZ_CORPUS], mutant;
+	result_t result;
+	unsigned run, kept = 0, size = 0, slot;
+
+	memset(covered, 0, sizeof(covered));
+	memset(worst, 0, sizeof(result_t));
+	for (run = 0; run < runs; run++) {
+		if (run < FUZZ_CORPUS/4) {
+			script_scenario(&mutant, run + 1, ticks);
+		} else {
+			// Breed from the costliest half the time
+			mutant = (fuzz_rand() & 0x01) ? *best : corpus[fuzz_rand() % size];
+			mutate(&mutant, &corpus[fuzz_rand() % size]);
+		}
+		play_scenario(&mutant, &result);
+		if (result.crashed) {
+			fprintf(stderr, "run %u: crashed the game at tick %u, seed %u, level %u\n",
+				run, result.played, mutant.seed, mutant.level);
+			*best = mutant;
+			*worst = result;
+			worst->cost = 0;
+			return;
+		}
+		if (!cover() && result.cost <= worst->cost) continue;
+
+		if (result.cost > worst->cost) {
+			*best = mutant;
+			*worst = result;
+			fprintf(stderr, "run %u: cost %u at tick %u, seed %u, level %u\n",
+				run, result.cost, result.tick, mutant.seed, mutant.level);
+		}
+		slot = (size < FUZZ_CORPUS) ? size++ : fuzz_rand() % FUZZ_CORPUS;
+		corpus[slot] = mutant;
+		kept++;
+	}
+	fprintf(stderr, "%u runs, %u kept\n", runs, kept);
+	minimise(best, worst);
+	return;
+}
+
+int main(int argc, char** argv) {
+	static scenario_t best;
+	unsigned seed = 1, runs = 2000, ticks = 500;
+	bool replaying = FALSE;
+	const char* path = NULL;
+	FILE* out = stdout;
+	result_t worst;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:n:t:o:r")) != -1) {
+		switch (opt) {
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 'n': runs = strtoul(optarg, NULL, 0); break;
+			case 't': ticks = strtoul(optarg, NULL, 0); break;
+			case 'o': path = optarg; break;
+			case 'r': replaying = TRUE; break;
+			default:
+				fprintf(stderr, "usage: %s [-s seed] [-n runs] [-t ticks] [-o scenario.txt]\n"
+					"       %s -r scenario.txt ...\n", argv[0], argv[0]);
+				return 2;
+		}
+	}
+	if (ticks == 0 || ticks > FUZZ_MAX_TICKS) return 2;
+
+	run = mmap(NULL, sizeof(run_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (run == MAP_FAILED) {
+		perror("mmap");
+		return 2;
+	}
+	setenv("SNAKE_FRAM", "/dev/null", 1);	// A blank FRAM, written nowhere
+	initialise_game_console();
+	if (replaying) return replay(&argv[optind], argc - optind) ? 0 : 1;
+
+	fuzz_random = (seed == 0) ? 1 : seed;
+	fuzz(runs, ticks, &best, &worst);
+	if (path != NULL) out = fopen(path, "w");
+	if (out == NULL) {
+		perror(path);
+		return 2;
+	}
+	save_scenario(out, &best, &worst);
+	if (out != stdout) fclose(out);
+	fprintf(stderr, "cost %u at tick %u, %u cycles\n", worst.cost, worst.tick, worst.cycles);
+	return worst.crashed ? 1 : 0;
+}
@@ -0,0 +1,299 @@
+/*************************************************************************
+Title: Snake Lockstep
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: None, a PC simulation of the solo game
+
+DESCRIPTION:
+	Plays solo games of snake in every lane of the lockstep engine, see
+	lockstep.c, and reports its throughput in game-ticks per second of a
+	single core, with each lane's walls buffer kept as well with -v. Each
+	lane is played by its own scripted player, from its own seed, and
+	starts a new game on the tick after its last one ended.
+
+	With -c, every lane is then played again, one at a time, on the
+	console's own code against the emulated hardware, and the two are
+	checked against each other after every tick: the head, its length and
+	the length it may grow to, the food, the view and whether the game is
+	over, and the walls buffer caching the view. Whenever a game ends, and
+	after the last tick, the whole world is compared as well. The
+	reference's throughput is reported alongside.
+
+	usage: snake_lockstep [-s seed] [-t ticks] [-l level] [-v] [-c]
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "console.h"
+#include "snake.h"
+#include "bench.h"
+#include "level.h"
+#include "world.h"
+#include "fram.h"
+#include "module.h"
+#include "lockstep.h"
+
+
+typedef struct {
+	int8_t head_x, head_y;
+	int8_t food_x, food_y;
+	int8_t view_x, view_y;
+	uint16_t length;
+	uint16_t max_length;
+	bool over;
+	uint32_t view;		// Hash of the walls buffer
+	uint32_t world;		// Hash of the world, once the game is over
+} lane_trace_t;
+
+
+/*
+ * Function:  script_press
+ * ------------------------
+ * Scripted player, like script_turn(), but with a generator per lane, so a
+ * lane plays the same whether it is played alone or alongside the others.
+ *
+ */
+static direction_t script_press(uint16_t* script) {
+	if (next_random(script) % TURN_CHANCE != 0) return NONE;
+	return next_random(script) % NONE;
+}
+
+static void seed_scripts(uint16_t scripts[], unsigned seed) {
+	uint8_t lane;
+	for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+		scripts[lane] = seed*LOCKSTEP_LANES + lane + 1;
+	}
+	return;
+}
+
+static double cpu_seconds(void) {
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+
+/*
+ * Function:  hash_world
+ * ----------------------
+ * Hashes every cell of a world, read with the given function.
+ *
+ */
+static uint32_t hash_world(obj_t (*read)(const void* games, uint8_t lane, point_t pt),
+						   const void* games, uint8_t lane) {
+	uint32_t hash = 2166136261u;
+	point_t pt;
+
+	for (pt.x = 0; pt.x < WORLD_COLUMNS; pt.x++) {
+		for (pt.y = 0; pt.y < WORLD_ROWS; pt.y++) {
+			hash = (hash ^ read(games, lane, pt))*16777619u;
+		}
+	}
+	return hash;
+}
+
+static uint32_t hash_view(const byte buffer[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE]) {
+	uint32_t hash = 2166136261u;
+	uint8_t x, row;
+	byte cell;
+
+	for (x = 0; x < MAX_SNAKE_COLUMN; x++) {
+		for (row = 0; row < MAX_SNAKE_ROW; row++) {
+			cell = buffer[x][row/SNAKE_ROWS_PER_PAGE] >> SNAKE_ROW_BIT_SIZE*(row%SNAKE_ROWS_PER_PAGE);
+			hash = (hash ^ (cell & 0b11))*16777619u;
+		}
+	}
+	return hash;
+}
+
+static obj_t read_lane(const void* games, uint8_t lane, point_t pt) {
+	return lockstep_cell(games, lane, pt);
+}
+
+static obj_t read_console(const void* games, uint8_t lane, point_t pt) {
+	return read_world_cell(pt);
+}
+
+
+/*
+ * Function:  play_lockstep
+ * -------------------------
+ * Plays every lane of a new engine for a number of ticks, restarting each 
+ * game as it ends.
+ *
+ *  views: Whether to keep each lane's walls buffer.
+ *  trace: If not NULL, filled in with each lane's state after every tick.
+ *  seconds: Set to the time taken.
+ *
+ *  returns: The number of games played.
+ *
+ */
+static unsigned play_lockstep(const byte level[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE], unsigned seed,
+							  unsigned ticks, bool views, lane_trace_t* trace, double* seconds) {
+	uint16_t scripts[LOCKSTEP_LANES];
+	direction_t presses[LOCKSTEP_LANES];
+	unsigned tick, played = 0;
+	uint8_t lane;
+	lane_trace_t* state;
+	lockstep_t* games = lockstep_create(level);
+	double start = cpu_seconds();
+
+	if (games == NULL) {
+		perror("lockstep");
+		exit(2);
+	}
+	games->cache_views = views;
+	seed_scripts(scripts, seed);
+	for (tick = 0; tick < ticks; tick++) {
+		for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+			if (tick == 0 || games->status[lane] != LANE_PLAYING) {
+				lockstep_start(games, lane, next_random(&scripts[lane]));
+				played++;
+			}
+			presses[lane] = script_press(&scripts[lane]);
+		}
+		lockstep_step(games, presses);
+		if (trace == NULL) continue;
+
+		for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+			state = &trace[tick*LOCKSTEP_LANES + lane];
+			state->head_x = games->head_x[lane];
+			state->head_y = games->head_y[lane];
+			state->food_x = games->food_x[lane];
+			state->food_y = games->food_y[lane];
+			state->view_x = games->view_x[lane];
+			state->view_y = games->view_y[lane];
+			state->length = games->length[lane];
+			state->max_length = games->max_length[lane];
+			state->over = games->status[lane] != LANE_PLAYING;
+			state->view = hash_view((const byte (*)[MAX_SNAKE_PAGE])games->walls[lane]);
+			state->world = (state->over || tick == ticks - 1) ? hash_world(read_lane, games, lane) : 0;
+		}
+	}
+	*seconds = cpu_seconds() - start;
+	lockstep_destroy(games);
+	return played;
+}
+
+
+/*
+ * Function:  check_lane
+ * ----------------------
+ * Plays a lane again on the console's own code, and compares it with the
+ * lockstep engine's trace after every tick.
+ *
+ *  seconds: Added to with the time spent in run_tick().
+ *
+ *  returns: True, if every tick matched.
+ *
+ */
+static bool check_lane(uint8_t lane, uint8_t level, unsigned seed, unsigned ticks,
+					   const lane_trace_t* trace, double* seconds) {
+	uint16_t scripts[LOCKSTEP_LANES];
+	direction_t press;
+	unsigned tick;
+	bool over = TRUE;
+	double start;
+	snake_t* snake;
+	lane_trace_t expect, got;
+
+	seed_scripts(scripts, seed);
+	flush_input();
+	for (tick = 0; tick < ticks; tick++) {
+		if (over) {
+			if (tick > 0) leave_module(&solo_snake);
+			srand(seed); // Generated levels are seeded from rand()
+			seed_food(next_random(&scripts[lane]));
+			select_level(level);
+			enter_module(&solo_snake);
+		}
+		press = script_press(&scripts[lane]);
+		if (press != NONE) push_input((button_t)press);
+
+		start = cpu_seconds();
+		over = !run_tick(&solo_snake);
+		*seconds += cpu_seconds() - start;
+
+		snake = get_snake(0);
+		memset(&got, 0, sizeof(got));
+		got.head_x = get_head_position(snake).x;
+		got.head_y = get_head_position(snake).y;
+		got.food_x = get_food(0).x;
+		got.food_y = get_food(0).y;
+		got.view_x = view.x;
+		got.view_y = view.y;
+		got.length = snake->length;
+		got.max_length = snake->max_length;
+		got.over = over;
+		got.view = hash_view((const byte (*)[MAX_SNAKE_PAGE])walls);
+		got.world = (over || tick == ticks - 1) ? hash_world(read_console, NULL, lane) : 0;
+
+		expect = trace[tick*LOCKSTEP_LANES + lane];
+		if (memcmp(&expect, &got, sizeof(lane_trace_t)) != 0) {
+			fprintf(stderr, "lane %u tick %u: head (%d,%d)/(%d,%d) food (%d,%d)/(%d,%d) "
+				"view (%d,%d)/(%d,%d) length %u/%u of %u/%u over %d/%d view %08x/%08x world %08x/%08x\n",
+				lane, tick, expect.head_x, expect.head_y, got.head_x, got.head_y,
+				expect.food_x, expect.food_y, got.food_x, got.food_y,
+				expect.view_x, expect.view_y, got.view_x, got.view_y,
+				expect.length, got.length, expect.max_length, got.max_length,
+				expect.over, got.over, expect.view, got.view, expect.world, got.world);
+			leave_module(&solo_snake);
+			return FALSE;
+		}
+	}
+	leave_module(&solo_snake);
+	return TRUE;
+}
+
+int main(int argc, char** argv) {
+	unsigned seed = 1, ticks = 2000, level = 0, games_played;
+	bool views = FALSE, check = FALSE, passed = TRUE;
+	byte level_walls[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE];
+	lane_trace_t* trace;
+	double seconds, reference = 0;
+	uint8_t lane;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:t:l:vc")) != -1) {
+		switch (opt) {
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 't': ticks = strtoul(optarg, NULL, 0); break;
+			case 'l': level = strtoul(optarg, NULL, 0) % LEVEL_COUNT; break;
+			case 'v': views = TRUE; break;
+			case 'c': check = TRUE; break;
+			default:
+				fprintf(stderr, "usage: %s [-s seed] [-t ticks] [-l level] [-v] [-c]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (ticks == 0) return 2;
+
+	initialise_game_console();
+	srand(seed);
+	load_level(level);
+	memcpy(level_walls, (const byte*)walls, sizeof(level_walls));
+
+	games_played = play_lockstep(level_walls, seed, ticks, views, NULL, &seconds);
+	printf("engine,lanes,ticks,games,game_ticks_per_s\n");
+	printf("%s,%u,%u,%u,%.0f\n", views ? "lockstep views" : "lockstep", LOCKSTEP_LANES, ticks,
+		games_played, (double)LOCKSTEP_LANES*ticks/seconds);
+	if (!check) return 0;
+
+	trace = calloc((size_t)ticks*LOCKSTEP_LANES, sizeof(lane_trace_t));
+	if (trace == NULL) {
+		perror("trace");
+		return 2;
+	}
+	play_lockstep(level_walls, seed, ticks, TRUE, trace, &seconds);
+	for (lane = 0; lane < LOCKSTEP_LANES; lane++) {
+		passed &= check_lane(lane, level, seed, ticks, trace, &reference);
+	}
+	printf("reference,%u,%u,%u,%.0f\n", LOCKSTEP_LANES, ticks, games_played,
+		(double)LOCKSTEP_LANES*ticks/reference);
+	free(trace);
+	fprintf(stderr, "%s\n",
+		passed ? "lockstep matches the reference" : "lockstep differs from the reference");
+	return passed ? 0 : 1;
+}
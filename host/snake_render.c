@@ -0,0 +1,117 @@
+/*************************************************************************
+Title: Snake Render
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: DOGS102 emulator
+
+DESCRIPTION:
+	Plays a scripted game of snake on the host against the ST7565 
+	emulator. Prints the SPI traffic of every tick as CSV and dumps the 
+	last frame, which can be compared against a golden image.
+
+	usage: snake_render [-s seed] [-t ticks] [-o frame.pgm] [-a frame.txt] 
+	                    [-g golden.pgm]
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "console.h"
+#include "snake.h"
+#include "bench.h"
+#include "module.h"
+#include "dogm-graphic.h"
+
+
+
+/*
+ * Function:  same_frame
+ * ----------------------
+ * Compares the emulated display against a PGM file written by st7565_write_pgm().
+ *
+ *  returns: True, if the file holds exactly the current frame.
+ *
+ */
+static bool same_frame(const char* path) {
+	char *frame = NULL, golden[8192];
+	size_t length = 0, golden_length;
+	FILE* out = open_memstream(&frame, &length);
+	FILE* in = fopen(path, "rb");
+	bool same;
+
+	st7565_write_pgm(&lcd_emulator, out);
+	fclose(out);
+	if (in == NULL) {
+		perror(path);
+		free(frame);
+		return FALSE;
+	}
+	golden_length = fread(golden, 1, sizeof(golden), in);
+	fclose(in);
+	same = (golden_length == length) && memcmp(golden, frame, length) == 0;
+	free(frame);
+	return same;
+}
+
+static void dump(const char* path, void (*writer)(const st7565_t*, FILE*)) {
+	FILE* out = fopen(path, "wb");
+	if (out == NULL) {
+		perror(path);
+		exit(2);
+	}
+	writer(&lcd_emulator, out);
+	fclose(out);
+	return;
+}
+
+int main(int argc, char** argv) {
+	const char *pgm = NULL, *ascii = NULL, *golden = NULL;
+	unsigned seed = 1, ticks = 200, tick;
+	st7565_count_t mark, cost;
+	bool alive = TRUE;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:t:o:a:g:")) != -1) {
+		switch (opt) {
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 't': ticks = strtoul(optarg, NULL, 0); break;
+			case 'o': pgm = optarg; break;
+			case 'a': ascii = optarg; break;
+			case 'g': golden = optarg; break;
+			default:
+				fprintf(stderr, "usage: %s [-s seed] [-t ticks] [-o frame.pgm] "
+					"[-a frame.txt] [-g golden.pgm]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	initialise_game_console();
+	srand(seed);
+	seed_food(seed);
+	flush_input();
+	
+	printf("tick,command_bytes,data_bytes,cursor_moves\n");
+	mark = lcd_emulator.count;
+	enter_module(&solo_snake);
+	for (tick = 0; alive && tick <= ticks; tick++) {
+		if (tick > 0) {
+			script_turn();
+			alive = run_tick(&solo_snake);
+		}
+		cost = st7565_since(&lcd_emulator, mark);
+		mark = lcd_emulator.count;
+		printf("%u,%u,%u,%u\n", tick, cost.command_bytes, cost.data_bytes, cost.cursor_moves);
+	}
+
+	if (pgm != NULL) dump(pgm, st7565_write_pgm);
+	if (ascii != NULL) dump(ascii, st7565_write_ascii);
+	if (golden != NULL && !same_frame(golden)) {
+		fprintf(stderr, "%s: frame differs from %s\n", argv[0], golden);
+		end_snake_game();
+		return 1;
+	}
+	end_snake_game();
+	return 0;
+}
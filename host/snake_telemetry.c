@@ -0,0 +1,205 @@
+/*************************************************************************
+Title: Snake Telemetry
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: USART emulated by a pseudo-terminal
+
+DESCRIPTION:
+	Plays scripted games of snake on the host with -DTELEMETRY, and sends 
+	the telemetry stream out of the emulated USART. Every byte the UDRE 
+	ISR would load into UDR is written out, to stdout by default, or to a
+	pseudo-terminal standing in for the serial port, so that the decoder
+	can be run against it exactly as against the real console:
+
+		./snake_telemetry -p &
+		../tools/telemetry_decode.py /dev/pts/N > telemetry.csv
+
+	With -p, the pseudo-terminal is hung up once the decoder has read the
+	whole stream, which ends the decoder.
+
+	The scripted player presses the arrow keys through the INT1 ISR, so
+	their latency is timed as on the console. By default every press is
+	made just before a tick. With -r, ticks are paced in real time and
+	each press lands at a random moment between two ticks, as a player's
+	would.
+
+	With -f, the open level is played by script_cycle() instead, until
+	the snake fills the board or the ticks run out, for the telemetry of
+	every tick of the worst case that time_full_board() sums up. It needs
+	a world of one screen, e.g. make RULES="-DWORLD_SCREENS_X=1
+	-DWORLD_SCREENS_Y=1".
+
+	usage: snake_telemetry [-s seed] [-t ticks] [-p] [-r] [-f]
+
+*************************************************************************/
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include "console.h"
+#include "snake.h"
+#include "bench.h"
+#include "module.h"
+
+#define PTY_IDLE_POLLS	20	// 10ms apart
+
+
+
+/*
+ * Function:  press_arrow
+ * -----------------------
+ * Scripted player, like script_turn(), but the arrow key is pressed through
+ * the INT1 ISR, which stamps the press.
+ *
+ */
+static void press_arrow(void) {
+	static const uint8_t pins[] = {UP_PIN, DOWN_PIN, LEFT_PIN, RIGHT_PIN};
+	uint8_t pin;
+	
+	if (rand() % TURN_CHANCE == 0) {
+		pin = pins[rand() % NONE];
+		PIND &= ~pin;
+		INT1_vect();
+		PIND |= pin;
+	}
+	return;
+}
+
+
+/*
+ * Function:  open_pty
+ * --------------------
+ * Opens a raw pseudo-terminal, so that no byte of the stream is translated. 
+ * The tool keeps the serial side open as well, so bytes written before the 
+ * decoder opens it are held rather than lost. Once the kernel's buffer is
+ * full, writes block until the decoder catches up.
+ *
+ *  port: Set to the serial side.
+ *
+ *  returns: The master side, or -1.
+ *
+ */
+static int open_pty(int* port) {
+	struct termios raw;
+	int pty = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (pty < 0 || grantpt(pty) < 0 || unlockpt(pty) < 0) {
+		perror("pty");
+		return -1;
+	}
+	*port = open(ptsname(pty), O_RDWR | O_NOCTTY);
+	if (*port < 0) {
+		perror(ptsname(pty));
+		return -1;
+	}
+	tcgetattr(*port, &raw);
+	cfmakeraw(&raw);
+	tcsetattr(*port, TCSANOW, &raw);
+	fprintf(stderr, "%s\n", ptsname(pty));
+	return pty;
+}
+
+
+/*
+ * Function:  wait_for_decoder
+ * ----------------------------
+ * Waits until everything written has been read from the serial side.
+ *
+ */
+static void wait_for_decoder(int port) {
+	int unread, idle = 0;
+	
+	// Bytes still on their way through the pty are not counted as unread yet
+	while (idle < PTY_IDLE_POLLS) {
+		usleep(10000);
+		if (ioctl(port, FIONREAD, &unread) < 0) return;
+		idle = (unread == 0) ? idle + 1 : 0;
+	}
+	return;
+}
+
+
+/*
+ * Function:  drain_usart
+ * -----------------------
+ * Runs the UDRE ISR until it switches itself off, writing out each byte it
+ * sends.
+ *
+ */
+static void drain_usart(int out) {
+	byte data;
+	while (UCSRB & _BV(UDRIE)) {
+		USART_UDRE_vect();
+		if (!(UCSRB & _BV(UDRIE))) break;
+		data = UDR;
+		if (write(out, &data, 1) != 1) {
+			perror("write");
+			exit(2);
+		}
+	}
+	return;
+}
+
+int main(int argc, char** argv) {
+	unsigned seed = 1, ticks = 1000, tick, pace = 1;
+	bool pty = FALSE, realtime = FALSE, full = FALSE;
+	int opt, port = -1, out = STDOUT_FILENO;
+
+	while ((opt = getopt(argc, argv, "s:t:prf")) != -1) {
+		switch (opt) {
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 't': ticks = strtoul(optarg, NULL, 0); break;
+			case 'p': pty = TRUE; break;
+			case 'r': realtime = TRUE; break;
+			case 'f': full = TRUE; break;
+			default:
+				fprintf(stderr, "usage: %s [-s seed] [-t ticks] [-p] [-r] [-f]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (pty) {
+		out = open_pty(&port);
+		if (out < 0) return 2;
+	}
+
+	initialise_game_console();
+	srand(seed);
+	seed_food(seed);
+	flush_input();
+	
+	// A new game is started whenever the snake crashes, but for a full board
+	if (full) select_level(FULL_BOARD_LEVEL);
+	enter_module(&solo_snake);
+	for (tick = 0; tick < ticks; tick++) {
+		if (full) {
+			script_cycle();
+		} else if (realtime) {
+			// The game's own random numbers are left alone, so -r plays the same game
+			usleep(rand_r(&pace) % (SPEED*1000));
+			press_arrow();
+			wait_for_tick();
+		} else {
+			press_arrow();
+		}
+		if (!run_tick(&solo_snake)) {
+			if (full) break;
+			leave_module(&solo_snake);
+			enter_module(&solo_snake);
+		}
+		drain_usart(out);
+	}
+	leave_module(&solo_snake);
+	fprintf(stderr, "dropped %u frames\n", telemetry_dropped);
+
+	if (pty) {
+		wait_for_decoder(port);
+		close(port);
+		close(out);
+	}
+	return 0;
+}
@@ -0,0 +1,159 @@
+/*************************************************************************
+Title: ST7565 Emulator
+Author: Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: DOGS102 (ST7565/UC1701 command set)
+
+DESCRIPTION:
+	Decodes the command/data byte stream sent to the DOGS102 and keeps 
+	a copy of its display RAM, so that frames rendered by draw.c can be 
+	checked and measured on a PC. Only the commands the console sends 
+	change any state; the rest are counted and ignored.
+
+	The display RAM is 132 columns wide, like the controller's, but only 
+	the first 102 columns are visible on the DOGS102.
+
+*************************************************************************/
+
+#include <string.h>
+#include "st7565.h"
+
+
+/*
+ * Function:  st7565_reset
+ * ------------------------
+ * Puts the emulator in its power-on state, with the counters cleared.
+ *
+ */
+void st7565_reset(st7565_t* lcd) {
+	memset(lcd, 0, sizeof(st7565_t));
+	return;
+}
+
+
+/*
+ * Function:  st7565_write
+ * ------------------------
+ * Clocks one byte into the controller. Data bytes are written to the display RAM 
+ * at the cursor, after which the column moves on by one. Commands that set the 
+ * page or column count as one cursor move, however many are sent in a row.
+ *
+ *  lcd: The emulated display.
+ *  a0: The level of the A0 pin; low for a command, high for data.
+ *  value: The byte sent over SPI.
+ *
+ */
+void st7565_write(st7565_t* lcd, uint8_t a0, uint8_t value) {
+	uint8_t addressing = 0;
+
+	if (a0) {
+		lcd->count.data_bytes++;
+		if (lcd->column < ST7565_COLUMNS) {
+			lcd->ram[lcd->page][lcd->column++] = value;
+		}
+		lcd->addressing = 0;
+		return;
+	}
+	
+	lcd->count.command_bytes++;
+	if (lcd->pending) {
+		if (lcd->pending == ST7565_VOLUME) lcd->contrast = value;
+		lcd->pending = 0;
+	} else if ((value & 0xF0) == ST7565_PAGE) {
+		lcd->page = (value & 0x0F) % ST7565_PAGES;
+		addressing = 1;
+	} else if ((value & 0xF0) == ST7565_COL_MSB) {
+		lcd->column = (lcd->column & 0x0F) | ((value & 0x0F) << 4);
+		addressing = 1;
+	} else if ((value & 0xF0) == ST7565_COL_LSB) {
+		lcd->column = (lcd->column & 0xF0) | (value & 0x0F);
+		addressing = 1;
+	} else if ((value & 0xC0) == ST7565_START_LINE) {
+		lcd->start_line = value & 0x3F;
+	} else if ((value & 0xFE) == ST7565_DISPLAY_ON) {
+		lcd->display_on = value & 0x01;
+	} else if (value == ST7565_VOLUME || value == ST7565_BOOSTER || value == ST7565_ADV_CONTROL) {
+		lcd->pending = value;
+	} else if (value == ST7565_RESET) {
+		lcd->page = 0;
+		lcd->column = 0;
+		lcd->start_line = 0;
+	}
+	
+	if (addressing && !lcd->addressing) {
+		lcd->count.cursor_moves++;
+	}
+	lcd->addressing = addressing;
+	return;
+}
+
+
+/*
+ * Function:  st7565_pixel
+ * ------------------------
+ * Reads back a visible pixel. Each RAM byte holds a column of 8 pixels, with the
+ * top pixel in the least significant bit.
+ *
+ *  returns: 1 if the pixel is lit.
+ *
+ */
+uint8_t st7565_pixel(const st7565_t* lcd, uint8_t x, uint8_t y) {
+	return (lcd->ram[y/8][x] >> (y%8)) & 0x01;
+}
+
+
+/*
+ * Function:  st7565_write_pgm
+ * ----------------------------
+ * Dumps the visible 102x64 frame as a binary PGM image, lit pixels in black.
+ *
+ */
+void st7565_write_pgm(const st7565_t* lcd, FILE* out) {
+	uint8_t x, y;
+	fprintf(out, "P5\n%d %d\n255\n", ST7565_WIDTH, ST7565_HEIGHT);
+	for (y = 0; y < ST7565_HEIGHT; y++) {
+		for (x = 0; x < ST7565_WIDTH; x++) {
+			fputc(st7565_pixel(lcd, x, y) ? 0 : 255, out);
+		}
+	}
+	return;
+}
+
+
+/*
+ * Function:  st7565_write_ascii
+ * ------------------------------
+ * Dumps the visible frame as text, one line per pixel row, with '#' for a lit 
+ * pixel and '.' otherwise.
+ *
+ */
+void st7565_write_ascii(const st7565_t* lcd, FILE* out) {
+	uint8_t x, y;
+	for (y = 0; y < ST7565_HEIGHT; y++) {
+		for (x = 0; x < ST7565_WIDTH; x++) {
+			fputc(st7565_pixel(lcd, x, y) ? '#' : '.', out);
+		}
+		fputc('\n', out);
+	}
+	return;
+}
+
+
+/*
+ * Function:  st7565_since
+ * ------------------------
+ * Finds the traffic received since an earlier copy of the counters, e.g. the 
+ * cost of a single game tick.
+ *
+ *  mark: lcd->count, as it was at the start of the interval.
+ *
+ *  returns: The bytes and cursor moves received since the mark.
+ *
+ */
+st7565_count_t st7565_since(const st7565_t* lcd, st7565_count_t mark) {
+	st7565_count_t delta;
+	delta.command_bytes = lcd->count.command_bytes - mark.command_bytes;
+	delta.data_bytes = lcd->count.data_bytes - mark.data_bytes;
+	delta.cursor_moves = lcd->count.cursor_moves - mark.cursor_moves;
+	return delta;
+}
@@ -0,0 +1,61 @@
+/*************************************************************************
+Title:    ST7565 Emulator Header File
+Author : Patrick Lewien (694555)
+Software: GCC (host)
+Hardware: DOGS102 (ST7565/UC1701 command set)
+
+DESCRIPTION:
+	Emulates the display controller of the DOGS102 from the SPI byte 
+	stream, with A0 low for commands and high for display data. Keeps 
+	the display RAM and counts the bytes and cursor moves it receives.
+
+*************************************************************************/
+
+#ifndef _ST7565_H_
+#define _ST7565_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+//Command Interface
+#define ST7565_PAGES		8
+#define ST7565_COLUMNS		132
+#define ST7565_WIDTH		102	// Visible columns on the DOGS102
+#define ST7565_HEIGHT		64
+#define ST7565_PAGE			0xB0 // Same as CMD_PAGE
+#define ST7565_COL_LSB		0x00 // Same as CMD_COL_LSB
+#define ST7565_COL_MSB		0x10 // Same as CMD_COL_MSB
+#define ST7565_START_LINE	0x40
+#define ST7565_DISPLAY_ON	0xAE // | 1 for on
+#define ST7565_VOLUME		0x81 // Followed by the contrast
+#define ST7565_BOOSTER		0xF8 // Followed by the booster ratio
+#define ST7565_ADV_CONTROL	0xFA // Followed by the UC1701 settings
+#define ST7565_RESET		0xE2
+
+typedef struct {
+	uint32_t command_bytes;
+	uint32_t data_bytes;
+	uint32_t cursor_moves;	// Runs of page/column address commands
+} st7565_count_t;
+
+typedef struct {
+	uint8_t ram[ST7565_PAGES][ST7565_COLUMNS];
+	uint8_t page;
+	uint8_t column;
+	uint8_t pending;		// First byte of a two-byte command
+	uint8_t addressing;		// Last byte was a page/column address
+	uint8_t start_line;
+	uint8_t contrast;
+	uint8_t display_on;
+	st7565_count_t count;
+} st7565_t;
+
+// Emulator function declarations
+void 	st7565_reset(st7565_t* lcd);
+void 	st7565_write(st7565_t* lcd, uint8_t a0, uint8_t value);
+uint8_t st7565_pixel(const st7565_t* lcd, uint8_t x, uint8_t y);
+void 	st7565_write_pgm(const st7565_t* lcd, FILE* out);
+void 	st7565_write_ascii(const st7565_t* lcd, FILE* out);
+st7565_count_t st7565_since(const st7565_t* lcd, st7565_count_t mark);
+
+#endif
@@ -0,0 +1,68 @@
+/*************************************************************************
+Title:    Benchmark Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Macros for the benchmark build. Compile with -DBENCHMARK to run the
+	benchmarks at power-up, before the game loop starts.
+
+*************************************************************************/
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+// Benchmark function declarations
+void 		run_benchmarks(void);
+void 		wait_for_a_button(void);
+bool 		time_boot(void);
+bool 		soak_heap(void);
+bool 		time_levels(void);
+bool 		time_generation(void);
+bool 		time_snakes(void);
+bool 		time_scrolling(void);
+bool 		time_switching(void);
+bool 		time_rewind(void);
+bool 		time_head_step(void);
+bool 		time_board(void);
+bool 		time_restart(void);
+bool 		time_full_board(void);
+bool 		time_body(void);
+uint32_t 	world_checksum(void);
+void 		seed_game(uint16_t seed);
+void 		script_turn(void);
+void 		script_cycle(void);
+void 		report_result(uint8_t page, const char* label, int16_t value);
+
+//Soak Interface
+#define SOAK_GAMES			2000	// Games played back to back
+#define SOAK_BATCH			100		// Games averaged into each trend sample
+#define SOAK_WARMUP			2		// Batches played before the baseline is taken
+#define SOAK_MAX_TICKS		1000	// Cap on the length of a scripted game
+#define SOAK_SLACK			2		// Free-list growth tolerated over the baseline
+#define TURN_CHANCE			4		// Scripted player turns every ~4 ticks
+
+#define GENERATE_SEEDS		20		// Layouts timed per kind
+#define MATCH_TICKS			1000	// Ticks timed per number of snakes
+#define BOARD_LCD_BYTES		(MAX_SNAKE_DISPLAY_PAGE*(LCD_MOVE_BYTES + MAX_SNAKE_COLUMN*SNAKE_WIDTH))
+#define SWITCH_TICKS		20		// Ticks played before switching to the next game
+#define SCROLL_BUDGET		(TICK_CYCLES/10)	// Per scroll step, including its FRAM reads
+#define REWIND_WARMUP		40		// Ticks played before the state to rewind to
+#define REWIND_SEEDS		10		// Games tried for one long enough to rewind
+#define RESTART_GAMES		5		// Levels played
+#define RESTART_ROUNDS		3		// Restarts of each level
+#define RESTART_SEED		7		// Every restart is seeded alike
+#define BODY_BENCH_LENGTH	300		// Nearly a screen, as long as a stream body gets
+#define BODY_BENCH_MOVES	2000
+#define BODY_BENCH_SEED		5
+#define FULL_BOARD_LEVEL	0		// The open level, which a single cycle covers
+#define FULL_BOARD_MAX_TICKS	30000	// Cap on the ticks taken to fill the board
+#define FULL_BOARD_SCREEN	(WORLD_SCREENS_X == 1 && WORLD_SCREENS_Y == 1)	// Only one screen can be filled
+
+//Timing Interface
+#define CYCLES_PER_US		(F_CPU/1000000UL)
+#define BOOT_US(CYCLES)		((int16_t)((CYCLES)/CYCLES_PER_US > INT16_MAX ? INT16_MAX : (CYCLES)/CYCLES_PER_US))	// A phase, capped to fit a result
+
+/*** End of Benchmark Header File ****/
+#endif
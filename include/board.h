@@ -0,0 +1,37 @@
+/*************************************************************************
+Title:    Board Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Macros for the bulk operations on the walls buffer, which work on the
+	four cells of a whole byte at a time.
+
+*************************************************************************/
+
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+// Board function declarations
+void 		fill_board(obj_t object);
+void 		fill_rect(obj_t object, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+void 		replace_cells(obj_t from, obj_t to);
+uint16_t 	count_cells(obj_t object);
+uint16_t 	count_rect(obj_t object, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+point_t 	find_cell(obj_t object, uint16_t n);
+void 		rect_masks(uint8_t y, uint8_t height, byte masks[]);
+byte 		match_cells(byte cells, obj_t object);
+uint8_t 	count_matches(byte matches);
+byte 		pack_cells(byte matches);
+
+//Board Interface
+#define BOARD_CELLS				(MAX_SNAKE_COLUMN*MAX_SNAKE_ROW)
+#define CELL_PAIRS				0x55	// The low bit of each cell in a byte
+#define ROW_BITS(ROWS)			((byte)((1U << (SNAKE_ROW_BIT_SIZE*(ROWS))) - 1)) // The first ROWS cells of a byte
+#define COUNT_ROW(OBJ, Y)		count_rect(OBJ, 0, Y, MAX_SNAKE_COLUMN, 1)
+#define COUNT_COLUMN(OBJ, X)	count_rect(OBJ, X, 0, 1, MAX_SNAKE_ROW)
+#define NO_CELL					((point_t){-1, -1})
+
+/*** End of Board Header File ****/
+#endif
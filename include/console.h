@@ -31,6 +31,32 @@ typedef struct {
 
 typedef enum {UP,DOWN,LEFT,RIGHT,NONE} direction_t;
 
+typedef struct {
+	uint32_t allocations;	// heap_alloc() calls since power-up
+	uint16_t live_blocks;	// blocks allocated but not yet freed
+	uint16_t free_blocks;	// length of the allocator's free-list
+	size_t largest_free;	// biggest chunk that can be reused without growing the heap
+	size_t used;			// heap bytes in live blocks (including chunk headers)
+	size_t peak;			// high-water mark of the heap extent
+} heap_stats_t;
+
+typedef enum {
+	BOOT_PORTS,			// Buttons, interrupts and the cycle counter
+	BOOT_LCD,			// Reset and start-up sequence, while the ADC converts
+	BOOT_FRAM,
+	BOOT_BACKLIGHT,
+	BOOT_SEED,			// Whatever is left of the ADC conversion
+	BOOT_FIRST_FRAME,	// Drawing the menu
+	BOOT_DEFERRED,		// Setup left until the menu is on screen
+	BOOT_PHASES
+} boot_phase_t;
+
+typedef struct {
+	uint32_t phases[BOOT_PHASES];	// Cycles spent in each phase
+	uint32_t first_frame;			// Cycles from the counter starting to the menu being drawn
+	uint32_t playable;				// To the menu taking presses, or 0 until then
+} boot_stats_t;
+
 /*ON OFF*/
 #define ON 		0xFF
 #define OFF 	0x00
@@ -44,6 +70,17 @@ typedef enum {UP,DOWN,LEFT,RIGHT,NONE} direction_t;
 #define FORWARD 0x00
 #define BACK 	0xFF
 
+/*Stack Painting*/
+#define STACK_PAINT		0xC5 // Written over unused RAM at power-up
+#define STACK_REPAINT_MARGIN	16
+
+/*Boot*/
+#define BOOT_TARGET_MS			50	// From power-up to the menu taking presses
+
+/*Game Over Screen*/
+#define GAME_OVER_FIRST_PAGE	2	// The pages the text is written over
+#define GAME_OVER_LAST_PAGE		5
+
 /*Helpful Macros*/
 #define SET(PORT,MASK,VALUE) 	PORT = ((MASK & VALUE) | (PORT & ~MASK))
 #define GET(PORT,MASK) 			PORT & MASK
@@ -51,10 +88,24 @@ typedef enum {UP,DOWN,LEFT,RIGHT,NONE} direction_t;
 
 // Function declarations
 void 	initialise_game_console();
-void 	display_game_over_screen();
+void 	start_game_console(void);
+void 	finish_game_console(void);
+bool 	display_game_over_screen(void);
 int 	check_free_ram (void);
+void* 	heap_alloc(size_t size);
+void 	heap_free(void* ptr);
+void 	get_heap_stats(heap_stats_t* stats);
+void 	reset_heap_peak(void);
+void 	paint_stack(void) __attribute__((naked, used, section(".init1")));
+uint16_t stack_high_water(void);
+void 	repaint_stack(void);
+uint16_t stack_headroom(void);
+uint32_t get_cycles(void);
 void 	LCD_clear();
 void 	srand_adc(void);
+uint16_t next_random(uint16_t* state);
+
+extern boot_stats_t boot_stats;
 
 /*ATMEGA16 Pins*/
 #define ADC_1v5_PIN		_BV(PA3)	
@@ -134,6 +185,7 @@ void 	srand_adc(void);
 #define DOWN_BUTTON 						~GET(PIND,DOWN_PIN)
 #define ACTION_A_BUTTON 					~GET(PINC,A_PIN)
 #define ACTION_B_BUTTON 					~GET(PINC,B_PIN)
+#define ANY_ARROW_BUTTON 					~GET(PIND,ALL_ARROW_PIN)
 #define INTERRUPT							GET(PIND,INT1)
 
 //Backlight Interface
@@ -150,6 +202,14 @@ void 	srand_adc(void);
 #define SCK_SET(STATE)						SET(PORTB,SCK_PIN,STATE)
 #define MOSI_SET(STATE)						SET(PORTB,MOSI_PINSTATE)	
 #define SETUP_SPI 							SET(SPCR,SPI_ENABLE,ON)
+#define SPI_TRANSFER_DONE					(SPSR & _BV(SPIF))
+
+//USART Interface
+#define SETUP_USART_BAUD(UBRR)				UBRRH=((UBRR)>>8); UBRRL=((UBRR)&0xFF)
+#define SETUP_USART_8N1						UCSRC=_BV(URSEL)|_BV(UCSZ1)|_BV(UCSZ0)
+#define ENABLE_USART_TX						UCSRB|=_BV(TXEN)
+#define ENABLE_UDRE_INTERRUPT				UCSRB|=_BV(UDRIE)
+#define DISABLE_UDRE_INTERRUPT				UCSRB&=~_BV(UDRIE)
 
 //LCD Interface
 #define LCD_CHIP_SELECT 	SET(PORTD,LCD_CS_PIN,LOW)
@@ -159,6 +219,7 @@ void 	srand_adc(void);
 #define CMD_PAGE			0xB0
 #define CMD_COL_LSB 		0x00
 #define CMD_COL_MSB 		0x10
+#define LCD_MOVE_BYTES		3 // Page, column LSB and column MSB commands
 
 //LCD Dimensions
 #define BIT_PER_BYTE		8
@@ -172,6 +233,12 @@ void 	srand_adc(void);
 #define ENABLE_TIMER_INTERRUPT				TIMSK=_BV(TOIE1)
 #define INTERRUPT_TIMER_MODE(MODE)			TCCR1B=MODE
 #define TIMER_PRESCALE_1024					(_BV(CS10)|_BV(CS12))
+#define TIMER_PRESCALE_1					(_BV(CS10))
+#define TIMER_OVERFLOW_PENDING				(TIFR & _BV(TOV1))
+
+//Cycle Counter Interface
+#define CYCLES_PER_MS						(F_CPU/1000)
+#define BATTERY_CHECK_OVERFLOWS				1024 // Every ~9s, as with the old 1024 prescaler
 #define INTERRUPT_SENSE_CONTROL(MODE) 		MCUCR=MODE
 #define INT1_ANY_CHANGE_IN_LOGIC			(_BV(ISC10))
 #define INT1_RISING_EDGE 					(_BV(ISC11)|_BV(ISC10))
@@ -0,0 +1,40 @@
+/*************************************************************************
+Title:    FRAM Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Macros for the SPI FRAM on the console, which shares the SPI bus with
+	the LCD. The pins and opcodes are defined in console.h.
+
+*************************************************************************/
+
+#ifndef _FRAM_H_
+#define _FRAM_H_
+
+typedef struct {
+	uint16_t reads;			// read transactions
+	uint16_t writes;		// write transactions
+	uint32_t bytes_read;	// data bytes, not counting the opcode and address
+	uint32_t bytes_written;
+} fram_stats_t;
+
+// FRAM function declarations
+void 		fram_init(void);
+byte 		fram_transfer(byte data);
+void 		fram_begin(byte opcode, uint16_t address);
+void 		fram_read(uint16_t address, byte* data, uint16_t length);
+void 		fram_write(uint16_t address, const byte* data, uint16_t length);
+void 		fram_fill(uint16_t address, byte value, uint16_t length);
+byte 		fram_read_byte(uint16_t address);
+void 		fram_write_byte(uint16_t address, byte value);
+
+extern fram_stats_t fram_stats;
+
+//FRAM Interface
+#define FRAM_SIZE			2048	// FM25L16, 16 Kbit
+#define FRAM_HEADER_BYTES	3		// Opcode and a two-byte address
+
+/*** End of FRAM Header File ****/
+#endif
@@ -0,0 +1,51 @@
+/*************************************************************************
+Title:    Input Latency Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Macros for measuring the time from a button press to the head of the
+	snake being drawn in its new direction.
+
+*************************************************************************/
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#define LATENCY_BINS			16
+
+typedef struct {
+	uint16_t bins[LATENCY_BINS];	// Presses per LATENCY_BIN_MS, the last bin holds the rest
+	uint16_t count;			// Presses measured
+	uint16_t worst;			// Longest latency, in ms
+	uint32_t total;			// Sum of all latencies, in ms, for the mean
+	uint16_t latest;		// Measured during the last tick, or LATENCY_NONE
+} latency_stats_t;
+
+// Latency function declarations
+void 		stamp_input(void);
+void 		claim_input(void);
+void 		drop_input(void);
+void 		record_latency(bool turned);
+void 		reset_latency(void);
+void 		start_latency_screen(void);
+bool 		step_latency_screen(void);
+void 		render_latency_screen(void);
+void 		end_latency_screen(void);
+void 		describe_latency_screen(telemetry_t* frame);
+void 		draw_latency_bar(uint8_t bin, uint8_t height);
+
+extern latency_stats_t latency_stats;
+
+//Latency Interface
+#define LATENCY_BIN_MS			16	// So the bins cover a 200ms tick and its render
+#define LATENCY_NONE			0xFFFF
+#define LATENCY_BAR_WIDTH		(MAX_COLUMN/LATENCY_BINS)
+#define LATENCY_FIRST_PAGE		1	// Bars are drawn up from the bottom of the last page
+#define LATENCY_LAST_PAGE		6
+#define LATENCY_BAR_HEIGHT		((LATENCY_LAST_PAGE - LATENCY_FIRST_PAGE + 1)*PIXEL_PER_PAGE)
+#define LATENCY_POLL_MS			100	// Tick of the debug screen, which only polls the buttons
+
+/*** End of Input Latency Header File ****/
+#endif
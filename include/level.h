@@ -0,0 +1,42 @@
+/*************************************************************************
+Title:    Level Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Macros for the level maps stored in flash.
+
+*************************************************************************/
+
+#ifndef _LEVEL_H_
+#define _LEVEL_H_
+
+typedef enum {ROOMS, PILLARS, MAZE} layout_t;
+
+// Level function declarations
+void 		load_level(uint8_t level);
+void 		decode_level(const byte* map);
+uint16_t 	generate_level(layout_t layout, uint16_t seed);
+
+extern uint32_t level_load_cycles;
+
+//Level Interface
+#define MAP_COUNT			4	// Stored maps, followed by one level per layout
+#define LAYOUT_COUNT		3
+#define LEVEL_COUNT			(MAP_COUNT+LAYOUT_COUNT)
+#define CELLS_PER_BYTE		SNAKE_ROWS_PER_PAGE
+#define CELLS_PER_COLUMN	(MAX_SNAKE_PAGE*CELLS_PER_BYTE)
+#define LEVEL_CELLS			(MAX_SNAKE_COLUMN*CELLS_PER_COLUMN)
+#define RUN_OBJECT(CODE)	((CODE) >> 6)
+#define RUN_LENGTH(CODE)	(((CODE) & 0x3F) + 1)
+#define REPEAT_COLUMN		SPECIAL // Never part of a map, so marks a repeated column
+#define FILL_PATTERN(OBJ)	((OBJ)*0x55) // The object in all four cells of a byte
+
+//Generator Interface
+#define PILLAR_COUNT		10
+#define GENERATE_MAX_PASSES	16
+#define GENERATE_BUDGET		(TICK_CYCLES/2)
+
+/*** End of Level Header File ****/
+#endif
@@ -0,0 +1,59 @@
+/*************************************************************************
+Title:    Game Module Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Macros for the game modules and the services the console shares 
+	between them.
+
+*************************************************************************/
+
+#ifndef _MODULE_H_
+#define _MODULE_H_
+
+#include "telemetry.h"
+
+// The arrows match direction_t, so a button can be used as a direction
+typedef enum {BUTTON_UP, BUTTON_DOWN, BUTTON_LEFT, BUTTON_RIGHT, BUTTON_A, BUTTON_B, BUTTON_NONE} button_t;
+
+typedef struct {
+	char* name;				// Shown in the menu
+	uint16_t tick_ms;		// Time between ticks
+	void (*init)(void);		// Sets up a new game, and may draw the board
+	bool (*tick)(void);		// Advances the game; returns false once it is over
+	void (*render)(void);	// Draws anything the tick did not, e.g. the score
+	void (*teardown)(void);	// Frees everything init() took
+	void (*describe)(telemetry_t* frame);	// Fills in the game's own telemetry
+	void (*restart)(void);	// Plays again from the game over screen, or NULL for none
+} module_t;
+
+// Module function declarations
+void 		run_module(const module_t* module);
+bool 		run_tick(const module_t* module);
+void 		enter_module(const module_t* module);
+void 		leave_module(const module_t* module);
+void 		restart_module(const module_t* module);
+const module_t* run_menu(void);
+void 		draw_menu(uint8_t item);
+void 		draw_menu_cursor(uint8_t item, char cursor);
+void 		start_ticks(uint16_t period_ms);
+void 		set_tick_period(uint16_t period_ms);
+void 		wait_for_tick(void);
+void 		push_input(button_t button);
+button_t 	pop_input(void);
+void 		flush_input(void);
+
+extern const module_t* const modules[];
+extern const module_t solo_snake, versus_snake, duel_snake, latency_screen;
+
+//Module Interface
+#define MODULE_COUNT		4
+#define INPUT_QUEUE_SIZE	8	// Presses held until a game polls for them
+#define MENU_FIRST_PAGE		2
+#define MENU_COLUMN			12
+#define MENU_POLL_MS		20
+
+/*** End of Game Module Header File ****/
+#endif
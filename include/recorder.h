@@ -0,0 +1,59 @@
+/*************************************************************************
+Title:    Flight Recorder Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Macros for the flight recorder, which logs game events to FRAM. The
+	layout is decoded by tools/recorder_decode.py, so keep them in step.
+
+*************************************************************************/
+
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+typedef enum {REC_START, REC_TURN, REC_FOOD, REC_LENGTH, REC_OVERRUN, REC_CRASH, REC_END, REC_TICKS} event_kind_t;
+typedef enum {REC_RUNNING, REC_GAME_OVER, REC_FAULT} recorder_state_t;
+typedef enum {FAULT_NONE, FAULT_HEAP} fault_t;
+typedef enum {CRASH_WALL, CRASH_HEAD} crash_t; // Snakes are walls, so running into one is CRASH_WALL
+
+typedef struct {
+	uint8_t tick;		// Low byte of the tick it happened in
+	uint8_t kind;		// event_kind_t in the top 3 bits, then 5 bits of data
+	uint8_t value;
+} event_t;
+
+typedef struct {
+	uint8_t magic[2];
+	uint8_t state;		// recorder_state_t when the log was last written
+	uint8_t next;		// Slot the next event is written to
+	uint16_t total;		// Events written since the recorder was formatted, up to 0xFFFF
+	uint16_t lost;		// Events overwritten in RAM before they were spilled
+} recorder_header_t;
+
+// Recorder function declarations
+void 		init_recorder(void);
+void 		record_event(event_kind_t kind, uint8_t data, uint8_t value);
+void 		record_food(point_t pt);
+void 		record_tick(void);
+void 		spill_recorder(void);
+void 		flush_recorder(recorder_state_t state);
+void 		record_fault(fault_t fault);
+
+//Recorder Interface
+#define RECORDER_BASE			(WORLD_BASE + WORLD_BYTES)	// Straight after the world
+#define RECORDER_HEADER_BYTES	sizeof(recorder_header_t)
+#define RECORDER_EVENT_BYTES	sizeof(event_t)
+#define RECORDER_FREE_EVENTS	((FRAM_SIZE - RECORDER_BASE - RECORDER_HEADER_BYTES)/RECORDER_EVENT_BYTES)
+#define RECORDER_MAX_EVENTS		255	// The header's next slot is a byte, e.g. in a smaller world
+#define RECORDER_EVENTS			(RECORDER_FREE_EVENTS < RECORDER_MAX_EVENTS ? RECORDER_FREE_EVENTS : RECORDER_MAX_EVENTS)
+#define RECORDER_RAM_EVENTS		16	// Power of two; events held in RAM between spills
+#define RECORDER_SPILL			(RECORDER_RAM_EVENTS/2)
+#define RECORDER_MAGIC_0		'F'
+#define RECORDER_MAGIC_1		'R'
+#define EVENT_KIND(K, DATA)		(((K) << 5) | ((DATA) & 0x1F))
+#define EVENT_VALUE_CAP			0xFF
+
+/*** End of Flight Recorder Header File ****/
+#endif
@@ -0,0 +1,33 @@
+/*************************************************************************
+Title:    Rewind Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Macros for the history of per-tick deltas that lets the snake game be
+	played backwards.
+
+*************************************************************************/
+
+#ifndef _REWIND_H_
+#define _REWIND_H_
+
+// Rewind function declarations
+void 		clear_deltas(void);
+void 		push_delta(byte delta);
+byte 		pop_delta(void);
+uint8_t 	count_deltas(void);
+
+//Rewind Interface
+#define REWIND_BYTES			32	// Two ticks per byte
+#define REWIND_DELTAS			(2*REWIND_BYTES)
+#define REWIND_SPEED			2	// Ticks undone per tick while B is held
+#define DELTA_ATE				0x1	// The head ate the food
+#define DELTA_TAIL				0x2	// A tail cell was removed
+#define DELTA_TAIL_DIR(D)		((D) << 2)	// The direction of the node it was removed from
+#define DELTA_GET_TAIL_DIR(D)	((direction_t)(((D) >> 2) & 0x3))
+#define NO_DELTA				0xFF
+
+/*** End of Rewind Header File ****/
+#endif
@@ -0,0 +1,109 @@
+/*************************************************************************
+Title:    Rules Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	The rules of the snake game, picked when building rather than checked
+	on every tick, e.g. make RULES="-DRULE_EDGES=EDGES_SOLID". Each rule is
+	a macro here, so only the code for the rules picked is compiled into
+	the step of the game. tools/rules_report.py times each variant and
+	sizes its code.
+
+	RULE_EDGES		EDGES_WRAP: the snake comes back on the other side of
+					the world. EDGES_SOLID: the edge of the world is a wall,
+					and the view stops scrolling at it.
+	RULE_GROWTH		GROWTH_LINEAR: each food adds LENGTH_DELTA. GROWTH_TAPER:
+					LENGTH_DELTA up to TAPER_LENGTH, then a cell per food.
+					GROWTH_NONE: the snake stays at START_LENGTH.
+	RULE_SPEED		SPEED_FIXED: a tick every SPEED ms. SPEED_RAMP: the ticks
+					get shorter as the first snake grows, down to SPEED_MIN.
+	RULE_BODY		BODY_SEGMENTS: the body is a list of straight segments on
+					the heap, a node per turn. BODY_STREAM: the body is its
+					tail and a ring of 2-bit moves, one per cell, inside the
+					snake. It needs no heap, but a snake stops growing at
+					BODY_CELLS, the cells of a screen.
+
+	START_LENGTH and LENGTH_DELTA can be set the same way, and so can the
+	size of the world in screens, WORLD_SCREENS_X and WORLD_SCREENS_Y, see
+	snake.h. A world of one screen scrolls onto itself, so the snake can
+	fill the whole board, as time_full_board() needs.
+
+*************************************************************************/
+
+#ifndef _RULES_H_
+#define _RULES_H_
+
+//Rule Variants
+#define EDGES_WRAP			0
+#define EDGES_SOLID			1
+#define GROWTH_LINEAR		0
+#define GROWTH_TAPER		1
+#define GROWTH_NONE			2
+#define SPEED_FIXED			0
+#define SPEED_RAMP			1
+#define BODY_SEGMENTS		0
+#define BODY_STREAM			1
+
+#ifndef RULE_EDGES
+#define RULE_EDGES			EDGES_WRAP
+#endif
+#ifndef RULE_GROWTH
+#define RULE_GROWTH			GROWTH_LINEAR
+#endif
+#ifndef RULE_SPEED
+#define RULE_SPEED			SPEED_FIXED
+#endif
+#ifndef RULE_BODY
+#define RULE_BODY			BODY_SEGMENTS
+#endif
+#ifndef START_LENGTH
+#define START_LENGTH		15
+#endif
+#ifndef LENGTH_DELTA
+#define LENGTH_DELTA		5
+#endif
+
+//Edges Interface
+#if RULE_EDGES == EDGES_SOLID
+#define STEP_BACK(V, SIZE)	((V) - 1)
+#define STEP_ON(V, SIZE)	((V) + 1)
+#define OFF_WORLD(PT)		((uint8_t)(PT).x >= WORLD_COLUMNS || (uint8_t)(PT).y >= WORLD_ROWS)
+#define CAN_SCROLL(ORIGIN, STEP, VISIBLE, SIZE)	((STEP) > 0 ? (ORIGIN) + (VISIBLE) < (SIZE) : (ORIGIN) > 0)
+#else
+#define STEP_BACK(V, SIZE)	((V) == 0 ? (SIZE) - 1 : (V) - 1)
+#define STEP_ON(V, SIZE)	((V) == (SIZE) - 1 ? 0 : (V) + 1)
+#define OFF_WORLD(PT)		FALSE
+#define CAN_SCROLL(ORIGIN, STEP, VISIBLE, SIZE)	TRUE
+#endif
+
+//Growth Interface
+#define TAPER_LENGTH		50
+#if RULE_GROWTH == GROWTH_TAPER
+#if (TAPER_LENGTH - START_LENGTH) % LENGTH_DELTA != 0
+#error "TAPER_LENGTH must be START_LENGTH plus a whole number of LENGTH_DELTA"
+#endif
+#define GROW(LENGTH)		((LENGTH) + ((LENGTH) < TAPER_LENGTH ? LENGTH_DELTA : 1))
+#define SHRINK(LENGTH)		((LENGTH) - ((LENGTH) > TAPER_LENGTH ? 1 : LENGTH_DELTA))
+#elif RULE_GROWTH == GROWTH_NONE
+#define GROW(LENGTH)		(LENGTH)
+#define SHRINK(LENGTH)		(LENGTH)
+#else
+#define GROW(LENGTH)		((LENGTH) + LENGTH_DELTA)
+#define SHRINK(LENGTH)		((LENGTH) - LENGTH_DELTA)
+#endif
+
+//Speed Interface
+#define SPEED_MIN			80	//ms
+#define RAMP_MS_PER_CELL	2
+#define RAMP_PERIOD(LENGTH)	((int16_t)SPEED - ((int16_t)(LENGTH) - START_LENGTH)*RAMP_MS_PER_CELL > SPEED_MIN ? \
+							 (int16_t)SPEED - ((int16_t)(LENGTH) - START_LENGTH)*RAMP_MS_PER_CELL : SPEED_MIN)
+
+//Body Interface
+#define BODY_CELLS			350		// A screen of 25 by 14 cells, MAX_SEED, which a snake can fill
+#define BODY_MOVES_PER_BYTE	4
+#define BODY_BYTES			CEILING(BODY_CELLS, BODY_MOVES_PER_BYTE)
+
+/*** End of Rules Header File ****/
+#endif
@@ -13,6 +13,8 @@ DESCRIPTION:
 #define _SNAKE_H_
 
 #include <stdlib.h>
+#include "telemetry.h"
+#include "rules.h"
 
 // Struct declarations
 typedef struct {
@@ -30,55 +32,120 @@ struct node {
     node_t* ptr;
 };
 
+#if RULE_BODY == BODY_STREAM
 typedef struct {
-	byte length;
-	byte max_length;
+	uint16_t length;		// Cells, so the moves are one fewer
+	uint16_t max_length;	// Held at BODY_CELLS once grown_length reaches it
+	uint16_t grown_length;	// What max_length would be without that cap
+	point_t head;
+	point_t tail;
+	direction_t tail_dir;	// The move the tail cell was entered by
+	uint16_t oldest;		// Index of the oldest move in the ring
+	byte moves[BODY_BYTES];	// A 2-bit direction_t per move, from the tail to the head
+} snake_t;
+#else
+typedef struct {
+	uint16_t length;		// A snake may fill the board, which has more cells than a byte counts
+	uint16_t max_length;
 	node_t* head;
 	node_t* tail;
 } snake_t;
+#endif
+
+typedef enum {BUTTONS, ACTION_BUTTONS, AI} input_t;
+
+typedef struct {
+	snake_t snake;
+	direction_t dir;
+	input_t input;
+	bool alive;
+	point_t next;	// Where the head moves to this tick
+	uint16_t score;	// Its length, held once it has crashed
+} player_t;
 
 // Game function declarations
 void 		play_snake_game(void);
-void 		end_snake_game(snake_t* snake);
+void 		start_solo_snake(void);
+void 		start_versus_snake(void);
+void 		start_duel_snake(void);
+void 		start_snake_game(uint8_t count, const input_t inputs[]);
+void 		restart_snake_game(void);
+void 		place_snakes(void);
+bool 		step_snake_game(void);
+bool 		rewind_snake_game(void);
+void 		render_snake_game(void);
+void 		describe_snake_game(telemetry_t* frame);
+void 		end_snake_game(void);
+bool 		game_over(void);
+snake_t* 	get_snake(uint8_t player);
+point_t 	get_food(uint8_t player);
+void 		select_level(uint8_t number);
+direction_t next_direction(player_t* player, uint8_t index);
 direction_t update_direction(direction_t current);
+direction_t turn_direction(direction_t current, int8_t turn);
+direction_t steer_ai(player_t* player, point_t target);
+uint8_t 	wrap_distance(int8_t a, int8_t b, uint8_t size);
 void 		update_buffer(point_t pt, obj_t object);
+void 		cache_cell(point_t pt, obj_t object);
 address_t 	pt2bufferaddress(point_t pt);
+obj_t 		enter_cell(point_t pt);
 byte 		is_wall(point_t pt);
+obj_t 		get_object(point_t pt);
 void 		clear_walls(void);
 bool		equal_pts(point_t pt1, point_t pt2);
 
 // Snake function declarations
 point_t 	move_snake(snake_t* snake, direction_t dir);
-snake_t* 	create_snake(point_t starting_pos, direction_t dir);
+void 		create_snake(snake_t* snake, point_t starting_pos, direction_t dir);
 point_t 	add_to_head(snake_t* snake, direction_t dir);
 void 		push_head(snake_t* snake, point_t s_pos, direction_t dir);
 point_t 	get_head_position(snake_t* snake);
+direction_t get_head_direction(snake_t* snake);
+direction_t get_tail_direction(snake_t* snake);
+bool 		is_empty_snake(snake_t* snake);
+bool 		covers_point(snake_t* snake, point_t pt);
+uint16_t 	body_bytes(snake_t* snake);
 point_t 	remove_from_tail(snake_t* snake);
 point_t 	pop_tail(snake_t* snake);
 point_t 	pop_tail_tip(node_t* tail);
+point_t 	remove_from_head(snake_t* snake);
+point_t 	add_to_tail(snake_t* snake, direction_t dir);
 void 		increase_length(snake_t* snake);
+void 		decrease_length(snake_t* snake);
 void 		clear_snake(snake_t* snake);
-point_t 	move_pos(point_t pt, direction_t dir, byte dist);
+void 		recycle_snake(snake_t* snake);
+node_t* 	alloc_node(void);
+void 		free_spare_nodes(void);
+void 		erase_snake(snake_t* snake, bool head_drawn);
+uint8_t 	count_segments(snake_t* snake);
+point_t 	move_pos(point_t pt, direction_t dir, int16_t dist);
+point_t 	next_pos(point_t pt, direction_t dir);
 int8_t 		bound_check(int8_t val, uint8_t min, uint8_t max);
 
 // Food function declarations
 point_t		generate_food(void);
-point_t 	generate_random_location(void);
-point_t		check_food_collision(snake_t* snake, point_t food);
+void		seed_food(uint16_t seed);
+void		eat_food(snake_t* snake, point_t head);
 
 // Drawing function declarations
 byte 		write_display(point_t pt);
+void 		create_pixel_data(point_t pt, byte pixel_data[]);
+void 		draw_board(void);
+uint8_t 	draw_screen_column(uint8_t column);
+uint8_t 	draw_screen_row(uint8_t row);
 address_t	pt2display(point_t pt);
 byte		create_image(obj_t object, uint8_t idx);
 void 		draw(point_t s_pos);
 void		draw_food(point_t pt);
 void 		clear(point_t s_pos);
 void 		draw_minimap(void);
-void		write_score(uint8_t score);
+void		write_score(uint16_t score);
+void		write_player_score(uint8_t index, uint8_t count, uint16_t score);
 
 
 //Snake Interface
 #define SPEED 				200 //ms
+#define TICK_CYCLES			((uint32_t)SPEED*CYCLES_PER_MS)
 #define SNAKE_WIDTH			4
 #define SNAKE_ROWS_PER_PAGE	4 // Used to store multiple walls per byte in memory
 #define TEXT_HEIGHT			8
@@ -86,12 +153,29 @@ void		write_score(uint8_t score);
 #define MAX_SNAKE_ROW		((MAX_ROW-TEXT_HEIGHT)/SNAKE_WIDTH)
 #define SNAKE_ROW_BIT_SIZE	(BIT_PER_BYTE/SNAKE_ROWS_PER_PAGE)
 #define MAX_SNAKE_PAGE		4  //(CEILING(MAX_SNAKE_ROW, SNAKE_ROWS_PER_PAGE)
+#define SNAKE_ROWS_PER_DISPLAY_PAGE	(PIXEL_PER_PAGE/SNAKE_WIDTH)
+#define MAX_SNAKE_DISPLAY_PAGE	(MAX_SNAKE_ROW/SNAKE_ROWS_PER_DISPLAY_PAGE)
 #define MAX_SEED			(MAX_SNAKE_COLUMN*MAX_SNAKE_ROW)
+#ifndef WORLD_SCREENS_X
+#define WORLD_SCREENS_X		4	// The world is this many screens across
+#endif
+#ifndef WORLD_SCREENS_Y
+#define WORLD_SCREENS_Y		4	// and this many screens down
+#endif
+#define WORLD_COLUMNS		(MAX_SNAKE_COLUMN*WORLD_SCREENS_X)
+#define WORLD_ROWS			(MAX_SNAKE_ROW*WORLD_SCREENS_Y)
 
 #define START_X				(MAX_SNAKE_COLUMN/2)
 #define START_Y				(MAX_SNAKE_ROW/2)
-#define START_LENGTH		15
-#define LENGTH_DELTA		5
+#define MAX_SNAKES			4
+#define TURN_NONE			0
+#define TURN_LEFT			(-1)
+#define TURN_RIGHT			1
+#define OPPOSITE(DIR)		((direction_t)((DIR) ^ 1)) // UP/DOWN and LEFT/RIGHT differ in the lowest bit
+#define SCORE_PAGE			7
+#define SCORE_COLUMN		80
+
+extern byte walls[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE];	// The view, a 2-bit obj_t per cell, see module.c
 
 /*** End of Snake Header File ****/
 #endif
@@ -0,0 +1,46 @@
+/*************************************************************************
+Title:    Telemetry Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Macros for the per-tick telemetry sent over the USART. The frame 
+	layout is decoded by tools/telemetry_decode.py, so keep them in step.
+
+*************************************************************************/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+typedef struct {
+	uint16_t tick;				// Ticks since the game started
+	uint32_t logic_cycles;		// Spent in the module's tick()
+	uint32_t render_cycles;		// Spent in the module's render()
+	uint16_t spi_bytes;			// Sent to the LCD and FRAM during the tick, see spi_bytes_sent()
+	uint16_t free_ram;			// Gap between the stack and the heap
+	uint8_t length;				// Cells in the first snake, up to 255
+	uint8_t segments;			// Heap nodes in the first snake
+	uint16_t latency;			// Of an arrow key acted on during the tick in ms, or LATENCY_NONE
+} telemetry_t;
+
+// Telemetry function declarations
+void 		init_telemetry(void);
+bool 		send_telemetry(const telemetry_t* frame);
+void 		queue_telemetry(byte data);
+uint8_t 	telemetry_space(void);
+uint32_t 	spi_bytes_sent(void);
+
+extern uint16_t telemetry_dropped;
+
+//Telemetry Interface
+#define TELEMETRY_BAUD			38400
+#define TELEMETRY_UBRR			(F_CPU/16/TELEMETRY_BAUD - 1)
+#define TELEMETRY_BUFFER_SIZE	32	// Room for one frame in flight, and the start of the next
+#define TELEMETRY_INTERVAL		1	// Ticks between frames
+#define TELEMETRY_SYNC			0xA5
+#define TELEMETRY_PAYLOAD_BYTES	18
+#define TELEMETRY_FRAME_BYTES	(TELEMETRY_PAYLOAD_BYTES+2) // Sync, payload, checksum
+
+/*** End of Telemetry Header File ****/
+#endif
@@ -0,0 +1,50 @@
+/*************************************************************************
+Title:    World Header File
+Author : Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Macros for the scrolling world. The world is stored in FRAM, and the
+	walls buffer caches the part of it in view.
+
+*************************************************************************/
+
+#ifndef _WORLD_H_
+#define _WORLD_H_
+
+typedef struct {
+	uint16_t columns;	// column strips scrolled into view
+	uint16_t rows;		// row strips scrolled into view
+	uint32_t lcd_bytes;	// sent to redraw them, commands included
+	uint32_t cycles;	// spent scrolling, loading and redrawing
+} scroll_stats_t;
+
+// World function declarations
+void 		reset_view(void);
+bool 		in_view(point_t pt);
+point_t 	cached_point(point_t slot);
+void 		follow(point_t pt);
+int8_t 		centre_offset(int8_t val, int8_t origin, uint8_t visible, uint8_t size);
+void 		scroll_columns(int8_t step);
+void 		scroll_rows(int8_t step);
+void 		load_world_column(int8_t x);
+void 		load_world_row(int8_t y);
+uint16_t 	world_address(point_t pt);
+obj_t 		read_world_cell(point_t pt);
+void 		write_world_cell(point_t pt, obj_t object);
+void 		store_world(void);
+void 		clear_world(void);
+
+extern point_t view;
+extern scroll_stats_t scroll_stats;
+
+//World Interface
+#define WORLD_BASE			0x0000	// FRAM address of the world
+#define WORLD_COLUMN_BYTES	(WORLD_SCREENS_Y*MAX_SNAKE_PAGE)
+#define WORLD_BYTES			(WORLD_COLUMNS*WORLD_COLUMN_BYTES)
+#define SCROLL_SLACK_X		6	// How far the head may stray from the centre of the view
+#define SCROLL_SLACK_Y		3
+
+/*** End of World Header File ****/
+#endif
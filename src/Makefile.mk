@@ -28,6 +28,10 @@ GENDEPFLAGS = -MP -MD -MT $(*F).o # -MF $(DDIR)/$(@F).d
 CFLAGS = $(COMMON)
 CFLAGS += -Wall -gdwarf-2 -DF_CPU=7379300UL -Os -fsigned-char -fshort-enums
 CFLAGS += -I$(IDIR) -I$(EDIR) $(GENDEPFLAGS)
+CFLAGS += -fstack-usage   # Frame sizes for the stack-report target
+CFLAGS += $(RULES)        # Game rules, see rules.h
+# CFLAGS += -DBENCHMARK   # Run the benchmarks in bench.c at power-up
+# CFLAGS += -DTELEMETRY   # Stream per-tick metrics over the USART, see telemetry.c
 
 ## Linker flags
 LDFLAGS = $(COMMON)
@@ -42,7 +46,7 @@ HEX_EEPROM_FLAGS += --set-section-flags=.eeprom="alloc,load"
 # HEX_EEPROM_FLAGS += --change-section-lma .eeprom=0 # --no-change-warnings
 
 ## Header dependencies
-_INC = console.h snake.h
+_INC = console.h snake.h bench.h level.h fram.h world.h module.h telemetry.h latency.h recorder.h rewind.h board.h rules.h
 INCLUDE = $(patsubst %,$(IDIR)/%,$(_INC))
 
 ## External dependencies
@@ -54,7 +58,7 @@ _EOBJ = dogm-graphic.o font.o Fonts/font_fixed_8px.o
 EXTERNALOBJECTS = $(patsubst %,$(ODIR)/$(LIB)/%,$(_EOBJ))
 
 ## Objects that must be built in order to link
-_OBJ = console.o snake.o draw.o play.o
+_OBJ = console.o snake.o draw.o play.o level.o generate.o world.o fram.o module.o telemetry.o latency.o recorder.o rewind.o board.o bench.o
 OBJECTS = $(patsubst %,$(ODIR)/%,$(_OBJ))
 OBJECTS += $(EXTERNALOBJECTS)
 
@@ -115,6 +119,13 @@ $(BDIR):
 	@echo ---- $@ ----
 	mkdir -p $(BDIR)
 
+## Static stack-depth report
+.PHONY: stack-report
+stack-report: $(TARGET) | $(BDIR)
+	@echo ---- $@ ----
+	avr-objdump -d $(TARGET) > $(BDIR)/$(PROJECT).dis
+	python ../tools/stack_report.py $(BDIR)/$(PROJECT).dis $(ODIR)
+
 # Eye candy: AVR Studio 3.x does not check make's exit code but relies on
 # the following magic strings to be generated by the compile job.
 begin:
@@ -0,0 +1,906 @@
+/*************************************************************************
+Title: Benchmarks
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Benchmarks run on the console itself when built with -DBENCHMARK. The
+	games are played by a scripted player and no delay is added between 
+	ticks. Results are written to the LCD, one per page.
+
+	A-button: Continue to the game
+
+*************************************************************************/
+
+#include "console.h"
+#include "snake.h"
+#include "bench.h"
+#include "level.h"
+#include "world.h"
+#include "fram.h"
+#include "module.h"
+#include "rewind.h"
+#include "board.h"
+#include "dogm-graphic.h"
+
+#ifdef BENCHMARK
+
+#ifdef HOST
+#include <stdio.h>
+#endif
+
+extern volatile byte action_a_flag;
+
+
+/*
+ * Function:  run_benchmarks
+ * --------------------------
+ * Runs every benchmark in turn. Each one leaves its results on the screen, with
+ * a pass/fail on the top line, until the A-button is pressed.
+ *
+ */
+void run_benchmarks(void) {
+	bool passed;
+	
+	passed = time_boot();
+	report_result(0, "boot", passed);
+	wait_for_a_button();
+	
+	passed = soak_heap();
+	report_result(0, "soak", passed);
+	wait_for_a_button();
+	
+	passed = time_levels();
+	report_result(0, "levels", passed);
+	report_result(5, "stack", stack_high_water());
+	report_result(6, "headroom", stack_headroom());
+	wait_for_a_button();
+	
+	passed = time_generation();
+	report_result(0, "generate", passed);
+	wait_for_a_button();
+	
+	passed = time_snakes();
+	report_result(0, "snakes", passed);
+	wait_for_a_button();
+	
+	passed = time_scrolling();
+	report_result(0, "scrolling", passed);
+	wait_for_a_button();
+	
+	passed = time_switching();
+	report_result(0, "switching", passed);
+	wait_for_a_button();
+	
+	passed = time_rewind();
+	report_result(0, "rewind", passed);
+	wait_for_a_button();
+	
+	passed = time_head_step();
+	report_result(0, "head step", passed);
+	wait_for_a_button();
+	
+	passed = time_board();
+	report_result(0, "board ops", passed);
+	wait_for_a_button();
+	
+	passed = time_restart();
+	report_result(0, "restart", passed);
+	wait_for_a_button();
+	
+	passed = time_body();
+	report_result(0, "body", passed);
+	wait_for_a_button();
+	
+#if FULL_BOARD_SCREEN
+	passed = time_full_board();
+	report_result(0, "full board", passed);
+	wait_for_a_button();
+#endif
+	
+	LCD_clear();
+	return;
+}
+
+
+/*
+ * Function:  wait_for_a_button
+ * -----------------------------
+ * Leaves the results of a benchmark on the screen until the A-button is pressed.
+ *
+ */
+void wait_for_a_button(void) {
+	action_a_flag = FALSE;
+	while(action_a_flag == FALSE) {
+		_delay_ms(100);
+	}
+	action_a_flag = FALSE;
+	return;
+}
+
+
+/*
+ * Function:  soak_heap
+ * ---------------------
+ * Plays SOAK_GAMES scripted games back to back, to check that the malloc churn of 
+ * push_head()/pop_tail() and create_snake()/clear_snake() does not build up over time. 
+ * The heap is sampled every tick, and the worst free-list length and heap extent of 
+ * each game are averaged over a batch of games. The first batches after warm-up set 
+ * the baseline, and every later batch must stay within it.
+ *
+ *  returns: True, if no blocks leaked and the fragmentation and peak usage held steady.
+ *
+ */
+bool soak_heap(void) {
+	heap_stats_t stats;
+	const input_t inputs[] = {BUTTONS};
+	uint16_t game, tick, batch, worst_free;
+	uint32_t sum_free = 0, sum_peak = 0;
+	uint16_t avg_free, avg_peak, base_free = 0, base_peak = 0;
+	bool passed = TRUE;
+
+	for (game = 0; game < SOAK_GAMES; game++) {
+		seed_game(game);
+		flush_input();
+		reset_heap_peak();
+		worst_free = 0;
+		
+		start_snake_game(1, inputs);
+		for (tick = 0; tick < SOAK_MAX_TICKS && step_snake_game(); tick++) {
+			get_heap_stats(&stats);
+			if (stats.free_blocks > worst_free) worst_free = stats.free_blocks;
+			script_turn();
+		}
+		end_snake_game();
+		
+		get_heap_stats(&stats);
+		sum_free += worst_free;
+		sum_peak += stats.peak;
+		if (stats.live_blocks != 0) passed = FALSE; // Leaked nodes
+		
+		if ((game+1) % SOAK_BATCH == 0) {
+			batch = (game+1) / SOAK_BATCH;
+			avg_free = sum_free / SOAK_BATCH;
+			avg_peak = sum_peak / SOAK_BATCH;
+			if (batch == SOAK_WARMUP) {
+				base_free = avg_free;
+				base_peak = avg_peak;
+			} else if (batch > SOAK_WARMUP) {
+				if (avg_free > base_free + SOAK_SLACK) passed = FALSE;
+				if (avg_peak > base_peak + SOAK_SLACK*sizeof(node_t)) passed = FALSE;
+			}
+			LCD_clear();
+			report_result(1, "games", game+1);
+			report_result(2, "free-list", avg_free);
+			report_result(3, "peak", avg_peak);
+			report_result(4, "allocs/k", stats.allocations / 1000);
+			sum_free = 0;
+			sum_peak = 0;
+		}
+	}
+	return passed;
+}
+
+
+/*
+ * Function:  time_levels
+ * -----------------------
+ * Loads every level in turn and reports the slowest load, including the redraw.
+ *
+ *  returns: True, if every level loads within a single tick.
+ *
+ */
+bool time_levels(void) {
+	uint8_t level;
+	uint32_t slowest = 0;
+	
+	for (level = 0; level < LEVEL_COUNT; level++) {
+		load_level(level);
+		if (level_load_cycles > slowest) slowest = level_load_cycles;
+	}
+	clear_walls();
+	LCD_clear();
+	report_result(1, "load us", slowest / CYCLES_PER_US);
+	return slowest < TICK_CYCLES;
+}
+
+
+/*
+ * Function:  time_generation
+ * ---------------------------
+ * Generates GENERATE_SEEDS layouts of each kind, reporting the slowest, the most
+ * cells walled off by the reachability check, and the most stack used.
+ *
+ *  returns: True, if every layout was generated within a single tick.
+ *
+ */
+bool time_generation(void) {
+	layout_t layout;
+	uint16_t seed, walled, most_walled = 0, stack, most_stack = 0;
+	uint32_t cycles, slowest = 0;
+	
+	for (layout = ROOMS; layout <= MAZE; layout++) {
+		for (seed = 1; seed <= GENERATE_SEEDS; seed++) {
+			repaint_stack();
+			cycles = get_cycles();
+			walled = generate_level(layout, seed);
+			cycles = get_cycles() - cycles;
+			stack = stack_high_water();
+			
+			if (cycles > slowest) slowest = cycles;
+			if (walled > most_walled) most_walled = walled;
+			if (stack > most_stack) most_stack = stack;
+		}
+	}
+	clear_walls();
+	LCD_clear();
+	report_result(1, "gen us", slowest / CYCLES_PER_US);
+	report_result(2, "walled", most_walled);
+	report_result(3, "gen stack", most_stack);
+	return slowest < TICK_CYCLES;
+}
+
+
+/*
+ * Function:  time_snakes
+ * -----------------------
+ * Times the AI playing itself with 1, 2 and 4 snakes, starting a new game 
+ * whenever every snake has crashed, and reports the average time per tick.
+ * Only the ticks are timed, not the restarts between games.
+ *
+ *  returns: True, if the time per snake does not grow with the number of snakes.
+ *
+ */
+bool time_snakes(void) {
+	const input_t inputs[MAX_SNAKES] = {AI, AI, AI, AI};
+	uint8_t count, page = 1;
+	uint16_t tick;
+	uint32_t cycles, per_tick[MAX_SNAKES+1];
+	bool alive;
+	
+	seed_game(1);
+	for (count = 1; count <= MAX_SNAKES; count *= 2) {
+		start_snake_game(count, inputs);
+		per_tick[count] = 0;
+		for (tick = 0; tick < MATCH_TICKS; tick++) {
+			cycles = get_cycles();
+			alive = step_snake_game();
+			per_tick[count] += get_cycles() - cycles;
+			if (!alive) {
+				end_snake_game();
+				start_snake_game(count, inputs);
+			}
+		}
+		per_tick[count] /= MATCH_TICKS;
+		end_snake_game();
+	}
+	
+	for (count = 1; count <= MAX_SNAKES; count *= 2) {
+		report_result(page++, count == 1 ? "1 snake us" : (count == 2 ? "2 snakes us" : "4 snakes us"), 
+			per_tick[count] / CYCLES_PER_US);
+	}
+	return per_tick[MAX_SNAKES] / MAX_SNAKES <= per_tick[1] + per_tick[1]/4;
+}
+
+
+/*
+ * Function:  time_scrolling
+ * --------------------------
+ * Lets the AI roam the world for MATCH_TICKS ticks and reports how often the
+ * view scrolled, the LCD bytes and time per scroll step, and the FRAM traffic
+ * per tick, with the most transactions any one tick made. The traffic of 
+ * loading a new level after a crash is left out.
+ *
+ *  returns: True, if a scroll step sends well under a full redraw to the LCD,
+ *           and fits in SCROLL_BUDGET.
+ *
+ */
+bool time_scrolling(void) {
+	const input_t inputs[] = {AI};
+	fram_stats_t fram;
+	uint16_t tick, scrolls, busiest = 0, ops;
+	
+	seed_game(1);
+	start_snake_game(1, inputs);
+	fram_stats = (fram_stats_t){0};
+	scroll_stats = (scroll_stats_t){0};
+	for (tick = 0; tick < MATCH_TICKS; tick++) {
+		ops = fram_stats.reads + fram_stats.writes;
+		if (!step_snake_game()) {
+			fram = fram_stats;
+			end_snake_game();
+			start_snake_game(1, inputs);
+			fram_stats = fram;
+		}
+		ops = fram_stats.reads + fram_stats.writes - ops;
+		if (ops > busiest) busiest = ops;
+	}
+	end_snake_game();
+	
+	scrolls = scroll_stats.columns + scroll_stats.rows;
+	if (scrolls == 0) scrolls = 1;
+	report_result(1, "scrolls", scroll_stats.columns + scroll_stats.rows);
+	report_result(2, "lcd/scroll", scroll_stats.lcd_bytes / scrolls);
+	report_result(3, "scroll us", scroll_stats.cycles / scrolls / CYCLES_PER_US);
+	report_result(4, "fram rd/tick", fram_stats.bytes_read / MATCH_TICKS);
+	report_result(5, "fram wr/tick", fram_stats.bytes_written / MATCH_TICKS);
+	report_result(6, "fram ops max", busiest);
+	return scroll_stats.lcd_bytes / scrolls < BOARD_LCD_BYTES/4 && 
+		   scroll_stats.cycles / scrolls < SCROLL_BUDGET;
+}
+
+
+/*
+ * Function:  time_switching
+ * --------------------------
+ * Plays a few ticks of every game module, then switches to every other one, 
+ * and reports the slowest switch: the teardown of one game, and the init and
+ * first render of the next.
+ *
+ *  returns: True, if every switch took under a tick and left no heap blocks
+ *           behind.
+ *
+ */
+bool time_switching(void) {
+	const module_t *from, *to;
+	heap_stats_t stats;
+	uint8_t i, j, tick;
+	uint32_t cycles, slowest = 0;
+	bool passed = TRUE;
+	
+	seed_game(1);
+	for (i = 0; i < MODULE_COUNT; i++) {
+		for (j = 0; j < MODULE_COUNT; j++) {
+			from = modules[i];
+			to = modules[j];
+			enter_module(from);
+			for (tick = 0; tick < SWITCH_TICKS && from->tick(); tick++) {
+				from->render();
+			}
+			
+			cycles = get_cycles();
+			leave_module(from);
+			enter_module(to);
+			cycles = get_cycles() - cycles;
+			
+			leave_module(to);
+			get_heap_stats(&stats);
+			if (stats.live_blocks != 0) passed = FALSE;
+			if (cycles > slowest) slowest = cycles;
+		}
+	}
+	LCD_clear();
+	report_result(1, "switch us", slowest / CYCLES_PER_US);
+	return passed && slowest < TICK_CYCLES;
+}
+
+
+/*
+ * Function:  time_rewind
+ * -----------------------
+ * Lets the AI play the solo game until the history is full, then rewinds 
+ * all of it and checks that the world and the snake are back to where they
+ * were. Reports the time to undo a tick, and what the history costs. Games
+ * in which the AI crashes too soon are played again with the next seed.
+ *
+ *  returns: True, if the game was restored exactly, and B held down rewinds
+ *           within the time of a tick.
+ *
+ */
+bool time_rewind(void) {
+	const input_t inputs[] = {AI};
+	snake_t* snake = get_snake(0);
+	uint32_t cycles, before, slowest = 0;
+	point_t head;
+	uint16_t length;
+	uint8_t seed, tick, segments;
+	bool alive = FALSE, passed = TRUE;
+	
+	for (seed = 1; !alive && seed <= REWIND_SEEDS; seed++) {
+		seed_game(seed);
+		start_snake_game(1, inputs);
+		for (tick = 0, alive = TRUE; alive && tick < REWIND_WARMUP; tick++) {
+			alive = step_snake_game();
+		}
+		before = world_checksum();
+		head = get_head_position(snake);
+		length = snake->length;
+		segments = count_segments(snake);
+		
+		for (tick = 0; alive && tick < REWIND_DELTAS; tick++) {
+			alive = step_snake_game();
+		}
+		if (!alive) end_snake_game();
+	}
+	if (!alive) return FALSE;
+	
+	while (count_deltas() > 0) {
+		cycles = get_cycles();
+		rewind_snake_game();
+		cycles = get_cycles() - cycles;
+		if (cycles > slowest) slowest = cycles;
+	}
+	if (world_checksum() != before || !equal_pts(get_head_position(snake), head) ||
+		snake->length != length || count_segments(snake) != segments) passed = FALSE;
+	end_snake_game();
+	
+	LCD_clear();
+	report_result(1, "rewind us", slowest / CYCLES_PER_US);
+	report_result(2, "history s", (uint32_t)REWIND_DELTAS*SPEED / 1000);
+	report_result(3, "bytes", REWIND_BYTES);
+	report_result(4, "bytes/min", (uint32_t)REWIND_BYTES*60000 / ((uint32_t)REWIND_DELTAS*SPEED));
+	return passed && slowest*REWIND_SPEED < TICK_CYCLES;
+}
+
+
+/*
+ * Function:  time_head_step
+ * --------------------------
+ * Moves a head into every empty cell of the first two screens of a fresh solo 
+ * game, once with the lookups the game used to make, a food check, a wall check
+ * and then a draw, and once with enter_cell(). The cell is cleared again after
+ * each. Half the cells are out of view, as the heads of AI snakes can be, where
+ * every lookup goes to FRAM. Reports the average cycles and FRAM bytes of each.
+ *
+ *  returns: True, if enter_cell() is the quicker of the two.
+ *
+ */
+bool time_head_step(void) {
+	const input_t inputs[] = {AI};
+	uint32_t cycles, legacy = 0, single = 0, legacy_fram = 0, single_fram = 0;
+	uint16_t cells = 0;
+	point_t pt;
+	
+	seed_game(1);
+	start_snake_game(1, inputs);
+	for (pt.x = 0; pt.x < 2*MAX_SNAKE_COLUMN; pt.x++) {
+		for (pt.y = 0; pt.y < MAX_SNAKE_ROW; pt.y++) {
+			if (get_object(pt) != EMPTY) continue;
+			fram_stats = (fram_stats_t){0};
+			cycles = get_cycles();
+			if (get_object(pt) != FOOD && !is_wall(pt)) draw(pt);
+			legacy += get_cycles() - cycles;
+			legacy_fram += fram_stats.bytes_read + fram_stats.bytes_written;
+			clear(pt);
+			
+			fram_stats = (fram_stats_t){0};
+			cycles = get_cycles();
+			enter_cell(pt);
+			single += get_cycles() - cycles;
+			single_fram += fram_stats.bytes_read + fram_stats.bytes_written;
+			clear(pt);
+			cells++;
+		}
+	}
+	end_snake_game();
+	
+	LCD_clear();
+	report_result(1, "cells", cells);
+	report_result(2, "old cycles", legacy / cells);
+	report_result(3, "new cycles", single / cells);
+	report_result(4, "old fram", legacy_fram / cells);
+	report_result(5, "new fram", single_fram / cells);
+	return single < legacy;
+}
+
+
+/*
+ * Function:  time_board
+ * ----------------------
+ * Times the board operations on every level, against reading the same cells
+ * one at a time with get_object(). Every free cell is then found in turn with
+ * find_cell(), and checked to be free and to come after the one before. The
+ * averages per call are reported in cycles.
+ *
+ *  returns: True, if every count agreed with the cells read one at a time, 
+ *           every free cell was found, and counting a byte at a time is the 
+ *           quicker.
+ *
+ */
+bool time_board(void) {
+	uint32_t cycles, by_cell = 0, by_byte = 0, rows = 0, columns = 0, find = 0, fill = 0;
+	uint16_t counted, free_cells, in_rows, in_columns, n, finds = 0;
+	uint8_t level;
+	point_t pt, last;
+	bool passed = TRUE;
+	
+	for (level = 0; level < LEVEL_COUNT; level++) {
+		load_level(level);
+		cycles = get_cycles();
+		for (counted = 0, pt.x = 0; pt.x < MAX_SNAKE_COLUMN; pt.x++) {
+			for (pt.y = 0; pt.y < MAX_SNAKE_ROW; pt.y++) {
+				if (get_object(pt) == EMPTY) counted++;
+			}
+		}
+		by_cell += get_cycles() - cycles;
+		
+		cycles = get_cycles();
+		free_cells = count_cells(EMPTY);
+		by_byte += get_cycles() - cycles;
+		
+		cycles = get_cycles();
+		for (in_rows = 0, pt.y = 0; pt.y < MAX_SNAKE_ROW; pt.y++) {
+			in_rows += COUNT_ROW(EMPTY, pt.y);
+		}
+		rows += get_cycles() - cycles;
+		
+		cycles = get_cycles();
+		for (in_columns = 0, pt.x = 0; pt.x < MAX_SNAKE_COLUMN; pt.x++) {
+			in_columns += COUNT_COLUMN(EMPTY, pt.x);
+		}
+		columns += get_cycles() - cycles;
+		if (free_cells != counted || in_rows != counted || in_columns != counted) passed = FALSE;
+		
+		// The view is at the top-left screen, so slots and points line up
+		for (n = 0, last = NO_CELL; n < free_cells; n++) {
+			cycles = get_cycles();
+			pt = find_cell(EMPTY, n);
+			find += get_cycles() - cycles;
+			if (get_object(pt) != EMPTY || pt.x*MAX_SNAKE_ROW + pt.y <= last.x*MAX_SNAKE_ROW + last.y) {
+				passed = FALSE;
+			}
+			last = pt;
+		}
+		finds += free_cells;
+		if (!equal_pts(find_cell(EMPTY, free_cells), NO_CELL)) passed = FALSE;
+		
+		cycles = get_cycles();
+		fill_board(EMPTY);
+		fill += get_cycles() - cycles;
+	}
+	clear_walls();
+	if (finds == 0) finds = 1;
+	
+	LCD_clear();
+	report_result(1, "cell count", by_cell / LEVEL_COUNT);
+	report_result(2, "byte count", by_byte / LEVEL_COUNT);
+	report_result(3, "row count", rows / LEVEL_COUNT / MAX_SNAKE_ROW);
+	report_result(4, "col count", columns / LEVEL_COUNT / MAX_SNAKE_COLUMN);
+	report_result(5, "find", find / finds);
+	report_result(6, "fill", fill / LEVEL_COUNT);
+	return passed && by_byte < by_cell;
+}
+
+
+/*
+ * Function:  time_boot
+ * ---------------------
+ * Boots the console again as it boots at power-up, up to the menu taking
+ * presses, and reports each phase of it. The LCD is reset again, so its
+ * delays are timed as they are at power-up; only the C runtime before
+ * main() is left out. The ports, FRAM and backlight are reported as one.
+ *
+ *  returns: True, if the menu took presses within BOOT_TARGET_MS.
+ *
+ */
+bool time_boot(void) {
+	uint32_t setup;
+	
+	start_game_console();
+	draw_menu(0);
+	finish_game_console();
+	setup = boot_stats.phases[BOOT_PORTS] + boot_stats.phases[BOOT_FRAM] + boot_stats.phases[BOOT_BACKLIGHT];
+	
+	LCD_clear();
+	report_result(1, "lcd us", BOOT_US(boot_stats.phases[BOOT_LCD]));
+	report_result(2, "seed us", BOOT_US(boot_stats.phases[BOOT_SEED]));
+	report_result(3, "setup us", BOOT_US(setup));
+	report_result(4, "menu us", BOOT_US(boot_stats.phases[BOOT_FIRST_FRAME]));
+	report_result(5, "deferred us", BOOT_US(boot_stats.phases[BOOT_DEFERRED]));
+	report_result(6, "playable ms", boot_stats.playable / CYCLES_PER_MS);
+	report_result(7, "target ms", BOOT_TARGET_MS);
+	return boot_stats.playable <= (uint32_t)BOOT_TARGET_MS*CYCLES_PER_MS;
+}
+
+
+/*
+ * Function:  time_restart
+ * ------------------------
+ * Plays scripted solo games to game over, and times getting from there to the
+ * first tick of the next game both ways, including its first render: tearing
+ * the game down and starting the next level, with the clear of the game over 
+ * screen in between, as the console used to, and restart_snake_game(). The 
+ * average time and FRAM traffic of each are reported. 
+ *
+ * Each restart is seeded the same, so every restarted game must start on an
+ * identical world, whatever the game before it left behind, and with as many
+ * walls and free cells in view as the fresh start of the level had.
+ *
+ *  returns: True, if every restart left a clean board and restarting is the
+ *           quicker.
+ *
+ */
+bool time_restart(void) {
+	const input_t inputs[] = {BUTTONS};
+	uint32_t cycles, fresh = 0, again = 0, fresh_fram = 0, again_fram = 0, first = 0;
+	uint16_t tick, walls, free_cells;
+	uint8_t game, round;
+	bool passed = TRUE;
+	
+	for (game = 0; game <= RESTART_GAMES; game++) {
+		seed_game(game);
+		fram_stats = (fram_stats_t){0};
+		cycles = get_cycles();
+		if (game > 0) {
+			end_snake_game();
+			LCD_clear();
+		}
+		if (game == RESTART_GAMES) break;
+		start_snake_game(1, inputs);
+		render_snake_game();
+		if (game > 0) {
+			fresh += get_cycles() - cycles;
+			fresh_fram += fram_stats.bytes_read + fram_stats.bytes_written;
+		}
+		walls = count_cells(WALL);
+		free_cells = count_cells(EMPTY);
+		
+		for (round = 0; round < RESTART_ROUNDS; round++) {
+			flush_input();
+			for (tick = 0; tick < SOAK_MAX_TICKS && step_snake_game(); tick++) {
+				script_turn();
+			}
+			
+			seed_game(RESTART_SEED);
+			fram_stats = (fram_stats_t){0};
+			cycles = get_cycles();
+			restart_snake_game();
+			render_snake_game();
+			again += get_cycles() - cycles;
+			again_fram += fram_stats.bytes_read + fram_stats.bytes_written;
+			
+			if (count_cells(WALL) != walls || count_cells(EMPTY) != free_cells) passed = FALSE;
+			if (round == 0) first = world_checksum();
+			else if (world_checksum() != first) passed = FALSE;
+		}
+	}
+	fresh /= RESTART_GAMES - 1;
+	fresh_fram /= RESTART_GAMES - 1;
+	again /= RESTART_GAMES*RESTART_ROUNDS;
+	again_fram /= RESTART_GAMES*RESTART_ROUNDS;
+	
+	LCD_clear();
+	report_result(1, "start us", fresh / CYCLES_PER_US);
+	report_result(2, "restart us", again / CYCLES_PER_US);
+	report_result(3, "start fram", fresh_fram);
+	report_result(4, "restart fram", again_fram);
+	return passed && again < fresh;
+}
+
+
+/*
+ * Function:  time_body
+ * ---------------------
+ * Times the body store picked by RULE_BODY, on a snake of its own kept at
+ * BODY_BENCH_LENGTH cells while it wanders at random. No cells are drawn, so
+ * only the body is timed. Each move adds to the head and takes off the tail, 
+ * and a random cell of the first screen is looked for in the body, which
+ * it mostly misses, and so walks all of it. Reports the most RAM the body
+ * held, and the average cycles of each.
+ *
+ *  returns: True, if the body ends where it was walked to, and gave back
+ *           everything it allocated.
+ *
+ */
+bool time_body(void) {
+	const input_t inputs[] = {AI};
+	static snake_t snake;
+	uint32_t cycles, head = 0, tail = 0, query = 0;
+	uint16_t move, bytes = 0, removals = 0;
+	uint8_t segments = 0;
+	direction_t dir = RIGHT;
+	point_t probe, expected = {START_X, START_Y};
+	heap_stats_t before, after;
+	bool passed;
+	
+	seed_game(BODY_BENCH_SEED);
+	start_snake_game(1, inputs);
+	get_heap_stats(&before);
+	create_snake(&snake, (point_t){START_X, START_Y}, dir);
+	snake.max_length = BODY_BENCH_LENGTH;
+	for (move = 0; move < BODY_BENCH_MOVES; move++) {
+		if (rand() % TURN_CHANCE == 0) dir = turn_direction(dir, (rand() & 0x01) ? TURN_LEFT : TURN_RIGHT);
+		cycles = get_cycles();
+		add_to_head(&snake, dir);
+		head += get_cycles() - cycles;
+		expected = next_pos(expected, dir);
+		if (snake.length > snake.max_length) {
+			cycles = get_cycles();
+			remove_from_tail(&snake);
+			tail += get_cycles() - cycles;
+			removals++;
+		}
+		
+		probe = (point_t){rand() % MAX_SNAKE_COLUMN, rand() % MAX_SNAKE_ROW};
+		cycles = get_cycles();
+		covers_point(&snake, probe);
+		query += get_cycles() - cycles;
+		
+		if (body_bytes(&snake) > bytes) bytes = body_bytes(&snake);
+		if (count_segments(&snake) > segments) segments = count_segments(&snake);
+	}
+	passed = snake.length == snake.max_length && equal_pts(get_head_position(&snake), expected) &&
+		get_head_direction(&snake) == dir && covers_point(&snake, expected);
+	clear_snake(&snake);
+	free_spare_nodes();
+	get_heap_stats(&after);
+	passed &= after.live_blocks == before.live_blocks;
+	end_snake_game();
+	
+	LCD_clear();
+	report_result(1, "length", snake.max_length);
+	report_result(2, "body bytes", bytes);
+	report_result(3, "segments", segments);
+	report_result(4, "head cycles", head / BODY_BENCH_MOVES);
+	report_result(5, "tail cycles", tail / removals);
+	report_result(6, "query us", query / BODY_BENCH_MOVES / CYCLES_PER_US);
+	return passed;
+}
+
+
+/*
+ * Function:  time_full_board
+ * ---------------------------
+ * Plays the open level with script_cycle() until the snake fills the whole
+ * board, for the worst case of a tick: the longest snake to cut the tail of,
+ * the fewest free cells to find the food among, and the most to render. Each
+ * tick is timed as run_tick() times it, with its logic and render apart, and
+ * the SPI bytes it sent and the free RAM are sampled after it. The worst of
+ * each is reported, along with the length the snake reached and the peak of
+ * the heap.
+ *
+ * Only a world of one screen can be filled, as the view shows all of it
+ * wherever it scrolls to; in a larger world, food turns up off the cycle.
+ * Build with RULES="-DWORLD_SCREENS_X=1 -DWORLD_SCREENS_Y=1" to run it.
+ *
+ *  returns: True, if the snake filled the board, and no tick overran.
+ *
+ */
+bool time_full_board(void) {
+	const input_t inputs[] = {BUTTONS};
+	snake_t* snake = get_snake(0);
+	heap_stats_t stats;
+	uint32_t start, spi_bytes, logic, render, worst_logic = 0, worst_render = 0, worst_spi = 0;
+	uint16_t tick, board, length, free_ram, least_ram = UINT16_MAX;
+	bool alive = TRUE;
+	
+	seed_game(1);
+	select_level(FULL_BOARD_LEVEL);
+	flush_input();
+	reset_heap_peak();
+	start_snake_game(1, inputs);
+	render_snake_game();
+	board = MAX_SNAKE_COLUMN*MAX_SNAKE_ROW - (count_cells(WALL) - snake->length);
+	
+	for (tick = 0; alive && tick < FULL_BOARD_MAX_TICKS; tick++) {
+		script_cycle();
+		spi_bytes = spi_bytes_sent();
+		start = get_cycles();
+		alive = step_snake_game();
+		logic = get_cycles() - start;
+		if (alive) render_snake_game();
+		render = get_cycles() - start - logic;
+		spi_bytes = spi_bytes_sent() - spi_bytes;
+		
+		free_ram = check_free_ram();
+		if (logic > worst_logic) worst_logic = logic;
+		if (render > worst_render) worst_render = render;
+		if (spi_bytes > worst_spi) worst_spi = spi_bytes;
+		if (free_ram < least_ram) least_ram = free_ram;
+	}
+	length = snake->length;
+	get_heap_stats(&stats);
+	end_snake_game();
+	
+	LCD_clear();
+	report_result(1, "length", length);
+	report_result(2, "ticks", tick);
+	report_result(3, "logic us", worst_logic / CYCLES_PER_US);
+	report_result(4, "render us", worst_render / CYCLES_PER_US);
+	report_result(5, "spi bytes", worst_spi);
+	report_result(6, "heap peak", stats.peak);
+	report_result(7, "free ram", least_ram);
+	return length == board && worst_logic + worst_render < TICK_CYCLES;
+}
+
+
+/*
+ * Function:  world_checksum
+ * --------------------------
+ * Sums up the world stored in FRAM, a column at a time.
+ *
+ */
+uint32_t world_checksum(void) {
+	byte column[WORLD_COLUMN_BYTES];
+	uint32_t sum = 0;
+	uint8_t x, i;
+	
+	for (x = 0; x < WORLD_COLUMNS; x++) {
+		fram_read(WORLD_BASE + x*WORLD_COLUMN_BYTES, column, WORLD_COLUMN_BYTES);
+		for (i = 0; i < WORLD_COLUMN_BYTES; i++) {
+			sum = sum*31 + column[i];
+		}
+	}
+	return sum;
+}
+
+
+/*
+ * Function:  seed_game
+ * ---------------------
+ * Seeds both the scripted player and the food, so the same game is played 
+ * again from the same seed.
+ *
+ */
+void seed_game(uint16_t seed) {
+	srand(seed);
+	seed_food(seed);
+	return;
+}
+
+
+/*
+ * Function:  script_turn
+ * -----------------------
+ * Scripted player. Picks a new direction at random every few ticks, as if the 
+ * arrow keys had been pressed. Seed with seed_game() to replay the same game.
+ *
+ */
+void script_turn(void) {
+	if (rand() % TURN_CHANCE == 0) {
+		push_input((button_t)(rand() % NONE));
+	}
+	return;
+}
+
+
+/*
+ * Function:  script_cycle
+ * ------------------------
+ * Scripted player for filling the board. Steers the first snake around a 
+ * Hamiltonian cycle of the top-left screen, which passes every cell once:
+ * right along the even rows and left along the odd ones, from the second
+ * column, and back up the first column from the last row. The screen has an
+ * even number of rows, so the last row runs left into the first column. A
+ * snake heading against its row steps onto the next row first, which runs 
+ * its way.
+ *
+ */
+void script_cycle(void) {
+	snake_t* snake = get_snake(0);
+	point_t head = get_head_position(snake);
+	direction_t dir;
+	
+	if (head.x == 0) {
+		dir = (head.y == 0) ? RIGHT : UP;
+	} else if (head.y % 2 == 0) {
+		dir = (head.x < MAX_SNAKE_COLUMN - 1) ? RIGHT : DOWN;
+	} else {
+		dir = (head.x > 1 || head.y == MAX_SNAKE_ROW - 1) ? LEFT : DOWN;
+	}
+	if (dir == OPPOSITE(get_head_direction(snake))) dir = DOWN;
+	push_input((button_t)dir);
+	return;
+}
+
+
+/*
+ * Function:  report_result
+ * -------------------------
+ * Writes a labelled benchmark result to a page of the LCD. The host build also
+ * prints it to stdout.
+ *
+ */
+void report_result(uint8_t page, const char* label, int16_t value) {
+#ifdef HOST
+	printf("%s,%d\n", label, value);
+#endif
+	lcd_moveto_xy(page, 0);
+	lcd_putstr((char*)label);
+	lcd_moveto_xy(page, 70);
+	lcd_put_int(value);
+	return;
+}
+
+#endif
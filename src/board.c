@@ -0,0 +1,218 @@
+/*************************************************************************
+Title: Board
+Author: Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Bulk operations on the walls buffer. A byte of the buffer holds four
+	2-bit cells, and the AVR works a byte at a time, so rather than
+	decoding cells one by one, every operation works on all four cells of
+	a byte at once:
+
+	  - match_cells() compares every cell of a byte with an object, and
+	    leaves the low bit of each cell that matches. XOR-ing with the
+	    object filled into all four cells zeroes the cells that match.
+	  - count_matches() counts those bits with a 16-entry table in flash,
+	    a nibble at a time.
+	  - a rectangle is a run of columns, with the same mask of rows in
+	    every column, one mask per page. Whole bytes are masked in and
+	    out rather than cells.
+
+	The rows after the last on the board, in the last page, are never
+	counted or changed, except by fill_board().
+
+*************************************************************************/
+
+#include <string.h>
+#include "console.h"
+#include "snake.h"
+#include "level.h"
+#include "board.h"
+
+static const byte bit_count[16] PROGMEM = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+
+/*
+ * Function:  fill_board
+ * ----------------------
+ * Fills every cell of the walls buffer with the same object.
+ *
+ */
+void fill_board(obj_t object) {
+	memset(walls, FILL_PATTERN(object), sizeof(walls));
+	return;
+}
+
+
+/*
+ * Function:  fill_rect
+ * ---------------------
+ * Fills a rectangle of the walls buffer with the same object, a byte at a time.
+ * The rectangle must lie on the board; it does not wrap.
+ *
+ */
+void fill_rect(obj_t object, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+	byte masks[MAX_SNAKE_PAGE], mask, pattern = FILL_PATTERN(object);
+	uint8_t column, page;
+
+	rect_masks(y, height, masks);
+	for (column = x; column < x + width; column++) {
+		for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+			mask = masks[page];
+			SET(walls[column][page], mask, pattern);
+		}
+	}
+	return;
+}
+
+
+/*
+ * Function:  replace_cells
+ * -------------------------
+ * Replaces every cell of one object on the board with another.
+ *
+ */
+void replace_cells(obj_t from, obj_t to) {
+	byte masks[MAX_SNAKE_PAGE], mask, pattern = FILL_PATTERN(to);
+	uint8_t column, page;
+
+	rect_masks(0, MAX_SNAKE_ROW, masks);
+	for (column = 0; column < MAX_SNAKE_COLUMN; column++) {
+		for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+			mask = match_cells(walls[column][page], from) & masks[page];
+			mask |= mask << 1;
+			SET(walls[column][page], mask, pattern);
+		}
+	}
+	return;
+}
+
+
+/*
+ * Function:  count_cells
+ * -----------------------
+ *  returns: The number of cells on the board holding the object.
+ *
+ */
+uint16_t count_cells(obj_t object) {
+	return count_rect(object, 0, 0, MAX_SNAKE_COLUMN, MAX_SNAKE_ROW);
+}
+
+
+/*
+ * Function:  count_rect
+ * ----------------------
+ * Counts the cells of a rectangle holding an object, four cells at a time. The
+ * rectangle must lie on the board; it does not wrap. See COUNT_ROW and
+ * COUNT_COLUMN for a single row or column.
+ *
+ *  returns: The number of cells holding the object.
+ *
+ */
+uint16_t count_rect(obj_t object, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+	byte masks[MAX_SNAKE_PAGE];
+	uint8_t column, page;
+	uint16_t count = 0;
+
+	rect_masks(y, height, masks);
+	for (column = x; column < x + width; column++) {
+		for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+			if (masks[page] == 0) continue;
+			count += count_matches(match_cells(walls[column][page], object) & masks[page]);
+		}
+	}
+	return count;
+}
+
+
+/*
+ * Function:  find_cell
+ * ---------------------
+ * Finds the n-th cell on the board holding an object, counting down each column
+ * in turn. Whole bytes are skipped by their count, so only the byte holding the
+ * cell is searched cell by cell. With n picked at random below count_cells(),
+ * any free cell can be found in a single pass, however full the board is.
+ *
+ *  returns: The cell's slot in the walls buffer, as a column and row, or
+ *           NO_CELL if there are not that many.
+ *
+ */
+point_t find_cell(obj_t object, uint16_t n) {
+	byte masks[MAX_SNAKE_PAGE], matches;
+	uint8_t column, page, row, count;
+
+	rect_masks(0, MAX_SNAKE_ROW, masks);
+	for (column = 0; column < MAX_SNAKE_COLUMN; column++) {
+		for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+			matches = match_cells(walls[column][page], object) & masks[page];
+			count = count_matches(matches);
+			if (n >= count) {
+				n -= count;
+				continue;
+			}
+			for (row = 0; ; row++, matches >>= SNAKE_ROW_BIT_SIZE) {
+				if ((matches & 0x01) && n-- == 0) {
+					return (point_t){column, page*SNAKE_ROWS_PER_PAGE + row};
+				}
+			}
+		}
+	}
+	return NO_CELL;
+}
+
+
+/*
+ * Function:  rect_masks
+ * ----------------------
+ * Works out which cells of each page of a column lie within a run of rows. The
+ * run is cut off at the bottom of the board.
+ *
+ *  y, height: The run of rows.
+ *  masks: Filled in with the bits of those cells, one byte per page.
+ *
+ */
+void rect_masks(uint8_t y, uint8_t height, byte masks[]) {
+	uint8_t page, first, top, bottom, end = y + height;
+
+	if (end > MAX_SNAKE_ROW) end = MAX_SNAKE_ROW;
+	for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+		first = page*SNAKE_ROWS_PER_PAGE;
+		top = (y > first) ? y : first;
+		bottom = (end < first + SNAKE_ROWS_PER_PAGE) ? end : first + SNAKE_ROWS_PER_PAGE;
+		masks[page] = (top < bottom) ? ROW_BITS(bottom - first) & ~ROW_BITS(top - first) : 0;
+	}
+	return;
+}
+
+
+/*
+ * Function:  match_cells
+ * -----------------------
+ * Compares all four cells of a byte of the walls buffer with an object.
+ *
+ *  returns: The low bit of every cell holding the object, see CELL_PAIRS.
+ *
+ */
+byte match_cells(byte cells, obj_t object) {
+	byte same = ~(cells ^ FILL_PATTERN(object));
+	return same & (same >> 1) & CELL_PAIRS;
+}
+
+uint8_t count_matches(byte matches) {
+	return pgm_read_byte(&bit_count[matches & 0x0F]) + pgm_read_byte(&bit_count[matches >> 4]);
+}
+
+
+/*
+ * Function:  pack_cells
+ * ----------------------
+ * Squeezes the low bit of each cell of a byte into the bottom four bits, one
+ * bit per cell, e.g. to draw a cell as a single pixel.
+ *
+ */
+byte pack_cells(byte matches) {
+	matches &= CELL_PAIRS;
+	matches = (matches | (matches >> 1)) & 0x33;
+	return (matches | (matches >> 2)) & 0x0F;
+}
@@ -8,8 +8,8 @@ Hardware: ATMEGA16 @ 8Mhz
 DESCRIPTION:
 	Game Console is a PCB made in ELEN90064 Embedded System Design at 
 	The University of Melbourne. The code in this file includes everything
-	needed to power on the device and adjust the screen. Game files can
-	be loaded in as separate programs.
+	needed to power on the device and adjust the screen. Games are run
+	as modules picked from a menu, see module.c.
 	
 	Arrow keys: Move direction
 	A-button: Select option
@@ -21,41 +21,53 @@ DESCRIPTION:
 
 #include "console.h"
 #include "dogm-graphic.h"
-extern void play_snake_game(void);
+#include "fram.h"
+#include "snake.h"
+#include "module.h"
+#include "latency.h"
+#include "recorder.h"
+#ifdef BENCHMARK
+#include "bench.h"
+#endif
 
 
 /*********************************
  **		GLOBAL VARIABLES		**
  *********************************/
-volatile direction_t selected_direction = NONE;
 volatile byte action_a_flag = FALSE;
+volatile byte action_steering = FALSE; // A/B steer a snake instead
+volatile byte action_rewind = FALSE; // B rewinds the solo game instead
+volatile int8_t action_turn = 0;
+volatile uint16_t timer_overflows = 0;
+boot_stats_t boot_stats;
+static uint32_t boot_start, boot_mark;
 
 
 /*********************************
  **	INTERRUPT SERVICE ROUTINES  **
  *********************************/
 ISR(INT1_vect) { //Button NAND ISR
-	if (UP_BUTTON) {
-		selected_direction = UP;
-	}
-	if (DOWN_BUTTON) {
-		selected_direction = DOWN;
-	}
-	if (LEFT_BUTTON) {
-		selected_direction = LEFT;
-	}
-	if (RIGHT_BUTTON) {
-		selected_direction = RIGHT;
-	}
+	if (ANY_ARROW_BUTTON) stamp_input(); //First, for the latency to be timed from the edge
+	if (UP_BUTTON) push_input(BUTTON_UP);
+	if (DOWN_BUTTON) push_input(BUTTON_DOWN);
+	if (LEFT_BUTTON) push_input(BUTTON_LEFT);
+	if (RIGHT_BUTTON) push_input(BUTTON_RIGHT);
 	if (ACTION_A_BUTTON) { //Reset screen: debug only
-		action_a_flag = TRUE;
+		if (action_steering) action_turn = -1; //Turn left
+		else action_a_flag = TRUE;
+		push_input(BUTTON_A);
 	}
 	if (ACTION_B_BUTTON) { //Up the brightness
-		INCREASE_BRIGHTNESS;
+		if (action_steering) action_turn = 1; //Turn right
+		else if (!action_rewind) INCREASE_BRIGHTNESS;
+		push_input(BUTTON_B);
 	}
 }
 
-ISR(TIMER1_OVF_vect) { //Timer ISR for low battery LED
+ISR(TIMER1_OVF_vect) { //Timer ISR for cycle counter and low battery LED
+	timer_overflows++;
+	if (timer_overflows % BATTERY_CHECK_OVERFLOWS != 0) return;
+	
 	START_ADC_CONVERSION;
 	while(WAIT_FOR_CONVERSION);
 	if (LOW_POWER)
@@ -76,26 +88,71 @@ ISR(TIMER1_OVF_vect) { //Timer ISR for low battery LED
  *
  */
 int main(void) {
- 	initialise_game_console();
+	const module_t* module;
+	
+ 	start_game_console();
 	check_free_ram();
 
-	//TODO: Initalise game menu screen
+#ifdef BENCHMARK
+	finish_game_console(); // The benchmarks record and send telemetry
+	run_benchmarks();
+#endif
+
 	while(TRUE) {
-		play_snake_game();
-		display_game_over_screen();
+		module = run_menu();
+		run_module(module);
 	}
 	
 	return 0;
 }
 
 
+/*
+ * Function:  mark_boot
+ * ---------------------
+ * Ends a phase of the boot, and starts timing the next one.
+ *
+ */
+static void mark_boot(boot_phase_t phase) {
+	uint32_t now = get_cycles();
+	
+	boot_stats.phases[phase] = now - boot_mark;
+	boot_mark = now;
+	return;
+}
+
+
 /*
  * Function:  initialise_game_console
  * -----------------------------------
- * Console initialisation function to be run at power-up.
+ * Sets up the whole console at once, for a program with no menu to draw 
+ * first, e.g. the host tools.
  *
  */
-void initialise_game_console(void) {	
+void initialise_game_console(void) {
+	start_game_console();
+	finish_game_console();
+	return;
+}
+
+
+/*
+ * Function:  start_game_console
+ * ------------------------------
+ * Console initialisation to be run at power-up: everything the menu needs
+ * to be drawn. Each phase is timed into boot_stats. The cycle counter is
+ * started first, so that it times the rest. The conversion that seeds the 
+ * random generator is started before the LCD is set up, and runs during 
+ * its reset, instead of being waited on after.
+ *
+ */
+void start_game_console(void) {
+	//Set up the cycle counter first, to time the rest
+	ENABLE_TIMER_INTERRUPT;
+	INTERRUPT_TIMER_MODE(TIMER_PRESCALE_1); // Free-running cycle counter
+	boot_stats = (boot_stats_t){{0}};
+	boot_mark = boot_start = get_cycles();
+	
 	//Set up low power LED
 	BAT_LOW_LED(OFF); //Make sure it is off before changing direction
 	BAT_LOW_LED_DIR(OUT); //Set BATTERY LED I/Os as outputs
@@ -114,22 +171,50 @@ void initialise_game_console(void) {
 	//Set up interrupts
 	ENABLE_INT1;
 	INTERRUPT_SENSE_CONTROL(INT1_RISING_EDGE);
-	ENABLE_TIMER_INTERRUPT;
-	INTERRUPT_TIMER_MODE(TIMER_PRESCALE_1024);
 	sei(); //Enable global interrupts
+	mark_boot(BOOT_PORTS);
 
-	//Set up SPI with LCD display
+	//Set up SPI with LCD display, gathering the seed meanwhile
+	START_ADC_CONVERSION;
 	lcd_init();
 	lcd_set_font(FONT_FIXED_8, NORMAL);
+	mark_boot(BOOT_LCD);
+	fram_init(); // Shares the SPI bus set up for the LCD
+	mark_boot(BOOT_FRAM);
 	
 	//Set up LCD PWM
 	LCD_BACKLIGHT(OFF);
 	LCD_BACKLIGHT_DIR(OUT);
 	PWM_GENERATION_MODE(FAST_PWM);
 	SET_BRIGHTNESS(DEFAULT_BRIGHTNESS);
+	mark_boot(BOOT_BACKLIGHT);
 	
 	//Seed random generator
 	srand_adc();
+	mark_boot(BOOT_SEED);
+	return;
+}
+
+
+/*
+ * Function:  finish_game_console
+ * -------------------------------
+ * The rest of the initialisation, which nothing needs until a game is 
+ * picked, run once the menu is first on screen. Does nothing after the 
+ * first call since start_game_console().
+ *
+ */
+void finish_game_console(void) {
+	if (boot_stats.playable != 0) return;
+	mark_boot(BOOT_FIRST_FRAME);
+	boot_stats.first_frame = boot_mark - boot_start;
+	
+	init_recorder(); // Reads the log header from FRAM
+#ifdef TELEMETRY
+	init_telemetry();
+#endif
+	mark_boot(BOOT_DEFERRED);
+	boot_stats.playable = boot_mark - boot_start;
 
 	//Loading sequence finished
 	BAT_LOW_LED(OFF); 
@@ -173,34 +258,301 @@ void LCD_clear(void) {
  * The pseudo-random number generator is usually seeded with time(NULL). However,
  * in an AVR program, a reference time isn't kept. Instead, a random seed can be 
  * generated using the high-resolution bits of an analog-digital converter (ADC).
+ * The conversion must already have been started, and is waited on if it has
+ * not finished.
  *
  */
 void srand_adc(void) {
-	START_ADC_CONVERSION;
+	byte noise;
+	
 	while(WAIT_FOR_CONVERSION);
-	srand(ADCL);  // seed with low-byte of ADC
+	noise = ADCL;  // seed with low-byte of ADC
+	srand(noise);
+	seed_food(noise);
 	return;
 }
 
+
+/*
+ * Function:  next_random
+ * -----------------------
+ * A 16-bit xorshift generator. Each user keeps its own state, so that e.g. a
+ * level layout or the food of a game depends only on its own seed, and does
+ * not disturb the sequence of rand(). The state must not be zero.
+ *
+ */
+uint16_t next_random(uint16_t* state) {
+	*state ^= *state << 7;
+	*state ^= *state >> 9;
+	*state ^= *state << 8;
+	return *state;
+}
+
+#ifndef HOST // The host build has its own, in host/hal.c
+static uint32_t heap_allocations = 0;
+static uint16_t heap_live_blocks = 0;
+static size_t heap_peak = 0;
+
 int check_free_ram (void) {
   extern int __heap_start, *__brkval; 
   int v; 
   return (int) &v - (__brkval == 0 ? (int) &__heap_start : (int) __brkval); 
 }
 
-void display_game_over_screen(void) {
+
+/*
+ * Function:  heap_top
+ * --------------------
+ * The first address above the heap, which is where the stack is free to grow down to.
+ *
+ */
+static uint8_t* heap_top(void) {
+	extern int __heap_start, *__brkval;
+	return (uint8_t*)(__brkval == 0 ? &__heap_start : __brkval);
+}
+
+
+/*
+ * Function:  heap_extent
+ * -----------------------
+ * The number of bytes between the start of the heap and its current top.
+ *
+ */
+static size_t heap_extent(void) {
+	extern int __heap_start;
+	return (size_t)(heap_top() - (uint8_t*)&__heap_start);
+}
+
+
+/*
+ * Function:  heap_alloc
+ * ----------------------
+ * Wrapper around malloc() that keeps count of the blocks handed out, so that
+ * leaks and fragmentation can be tracked across games. The heap extent is 
+ * sampled after every allocation, since the heap only grows inside malloc().
+ *
+ *  size: The number of bytes requested.
+ *
+ *  returns: The allocated block, or NULL if the heap has run into the stack.
+ *
+ */
+void* heap_alloc(size_t size) {
+	void* ptr = malloc(size);
+	size_t extent;
 	
-	lcd_moveto_xy(2,20);
-	lcd_putstr("GAME OVER");
-	lcd_moveto_xy(4,13);
-	lcd_putstr("play again?");
-	action_a_flag = FALSE;
+	if (ptr != NULL) {
+		heap_allocations++;
+		heap_live_blocks++;
+		extent = heap_extent();
+		if (extent > heap_peak) heap_peak = extent;
+	}
+	return ptr;
+}
 
-	while(action_a_flag == FALSE) {
-		_delay_ms(100);
+
+/*
+ * Function:  heap_free
+ * ---------------------
+ * Counterpart to heap_alloc(). Only blocks from heap_alloc() should be passed in.
+ *
+ */
+void heap_free(void* ptr) {
+	if (ptr != NULL) {
+		heap_live_blocks--;
+		free(ptr);
+	}
+	return;
+}
+
+
+/*
+ * Function:  get_heap_stats
+ * --------------------------
+ * The free RAM reported by check_free_ram() is only the gap between the stack and
+ * the top of the heap. Chunks freed below the top are held in avr-libc's free-list
+ * and can only be reused by requests that fit in them, so the free-list is walked 
+ * here to report how fragmented the heap has become.
+ *
+ *  stats: Filled in with the current allocator statistics.
+ *
+ */
+void get_heap_stats(heap_stats_t* stats) {
+	// avr-libc internals, see stdlib_private.h
+	struct __freelist {
+		size_t sz;
+		struct __freelist *nx;
+	};
+	extern struct __freelist *__flp;
+	struct __freelist *fp;
+	size_t free_bytes = 0;
+
+	stats->allocations = heap_allocations;
+	stats->live_blocks = heap_live_blocks;
+	stats->free_blocks = 0;
+	stats->largest_free = 0;
+	for (fp = __flp; fp != NULL; fp = fp->nx) {
+		stats->free_blocks++;
+		free_bytes += fp->sz + sizeof(size_t);
+		if (fp->sz > stats->largest_free) stats->largest_free = fp->sz;
+	}
+	
+	stats->used = heap_extent() - free_bytes;
+	stats->peak = heap_peak;
+	return;
+}
+
+
+/*
+ * Function:  reset_heap_peak
+ * ---------------------------
+ * Restarts the heap high-water mark, e.g. at the start of every game.
+ *
+ */
+void reset_heap_peak(void) {
+	heap_peak = 0;
+	return;
+}
+
+
+/*
+ * Function:  paint_stack
+ * -----------------------
+ * Fills all RAM between the end of the static variables and the top of the stack 
+ * with STACK_PAINT before main() runs. Placed in .init1, which runs before the 
+ * stack pointer and __zero_reg__ are set up, so it is written in assembly and must 
+ * never be called.
+ *
+ */
+void paint_stack(void) {
+	__asm volatile (
+		"	ldi r30, lo8(_end)		\n"
+		"	ldi r31, hi8(_end)		\n"
+		"	ldi r24, %0				\n"
+		"	ldi r25, hi8(__stack)	\n"
+		"	rjmp 2f					\n"
+		"1:	st Z+, r24				\n"
+		"2:	cpi r30, lo8(__stack)	\n"
+		"	cpc r31, r25			\n"
+		"	brlo 1b					\n"
+		"	breq 1b					\n"
+		:: "M" (STACK_PAINT)
+	);
+}
+
+
+/*
+ * Function:  stack_high_water
+ * ----------------------------
+ * Finds the deepest the stack has reached since power-up, by searching up from
+ * the top of the heap for the first byte that no longer holds STACK_PAINT. ISRs 
+ * run on the same stack, so their nested calls are included. If the heap has 
+ * since shrunk, the bytes it used are counted as stack, so the result is an
+ * overestimate rather than an underestimate.
+ *
+ *  returns: The peak stack usage, in bytes.
+ *
+ */
+uint16_t stack_high_water(void) {
+	extern uint8_t __stack;
+	uint8_t *p = heap_top();
+	
+	while (p <= &__stack && *p == STACK_PAINT) {
+		p++;
 	}
+	return (uint16_t)(&__stack - p) + 1;
+}
+
+
+/*
+ * Function:  repaint_stack
+ * -------------------------
+ * Paints the unused RAM below the stack pointer again, so that stack_high_water()
+ * measures from now on, e.g. to find the stack used by a single routine. A 
+ * margin is left below the stack pointer for this function's own frame.
+ *
+ */
+void repaint_stack(void) {
+	uint8_t *p = heap_top();
+	uint8_t *sp = (uint8_t*)SP;
 	
-	action_a_flag = FALSE;
-	LCD_clear();
+	while (p < sp - STACK_REPAINT_MARGIN) {
+		*p++ = STACK_PAINT;
+	}
 	return;
 }
+
+
+/*
+ * Function:  stack_headroom
+ * --------------------------
+ * The number of painted bytes left between the top of the heap and the deepest 
+ * point the stack has reached. Unlike check_free_ram(), this includes the stack 
+ * used by ISRs and any calls made since the last check.
+ *
+ *  returns: The smallest gap there has been between the stack and the heap.
+ *
+ */
+uint16_t stack_headroom(void) {
+	extern uint8_t __stack;
+	
+	return (uint16_t)(&__stack - heap_top()) + 1 - stack_high_water();
+}
+
+
+/*
+ * Function:  get_cycles
+ * ----------------------
+ * Timer 1 counts every CPU cycle, and its overflows are counted by the timer ISR.
+ * Together they make a 32-bit cycle counter that wraps roughly every 10 minutes,
+ * which is plenty for timing anything up to a few ticks. Safe to call from an ISR.
+ *
+ *  returns: The number of CPU cycles since the timer was started.
+ *
+ */
+uint32_t get_cycles(void) {
+	uint8_t sreg = SREG;
+	uint16_t count, overflows;
+	
+	cli();
+	count = TCNT1;
+	overflows = timer_overflows;
+	if (TIMER_OVERFLOW_PENDING && count < 0x8000) {
+		overflows++; // Wrapped since the ISR last ran
+	}
+	SREG = sreg;
+	return ((uint32_t)overflows << 16) | count;
+}
+#endif
+
+/*
+ * Function:  display_game_over_screen
+ * ------------------------------------
+ * Writes the game over text over the last tick of a game, on the pages from 
+ * GAME_OVER_FIRST_PAGE to GAME_OVER_LAST_PAGE, and waits for a choice.
+ *
+ *  returns: True, to play again, or false to go back to the menu.
+ *
+ */
+bool display_game_over_screen(void) {
+	lcd_moveto_xy(GAME_OVER_FIRST_PAGE,20);
+	lcd_putstr("GAME OVER");
+	lcd_moveto_xy(GAME_OVER_LAST_PAGE-1,13);
+	lcd_putstr("A: main menu");
+	lcd_moveto_xy(GAME_OVER_LAST_PAGE,13);
+	lcd_putstr("B: play again");
+	
+	flush_input();
+	while (TRUE) {
+		switch (pop_input()) {
+			case BUTTON_A:
+				return FALSE;
+			case BUTTON_B:
+				return TRUE;
+			case BUTTON_NONE:
+				_delay_ms(MENU_POLL_MS);
+				break;
+			default:
+				break;
+		}
+	}
+}
@@ -11,15 +11,24 @@ DESCRIPTION:
 
 #include "console.h"
 #include "snake.h"
+#include "world.h"
+#include "board.h"
 #include "dogm-graphic.h"
 
-extern byte walls[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE];
+uint32_t lcd_bytes = 0; // Commands and data sent to draw the board, for telemetry
 
 
+/*
+ * Function:  pt2display
+ * ----------------------
+ * Finds where a point is drawn. Like the walls buffer, the screen wraps the 
+ * world around the view, so a point is always drawn at its buffer slot.
+ *
+ */
 address_t pt2display(point_t pt) {
 	address_t display;
-	display.column = (SNAKE_WIDTH*pt.x)%MAX_COLUMN;
-	display.page = ((SNAKE_WIDTH*pt.y)/PIXEL_PER_PAGE)%MAX_PAGE;
+	display.column = SNAKE_WIDTH*(pt.x % MAX_SNAKE_COLUMN);
+	display.page = (SNAKE_WIDTH*(pt.y % MAX_SNAKE_ROW))/PIXEL_PER_PAGE;
 	display.bit = 0;
 	return display;
 }
@@ -34,11 +43,38 @@ address_t pt2display(point_t pt) {
  *  pt: The position on the snake grid.
  *  value: ON or OFF, depending on whether the pixel is to be turned on or off.
  *
- *  returns: True.
+ *  returns: True, or false if the point is out of view and was not drawn.
  *
  */
 byte write_display(point_t pt) {
+	byte i, pixel_data[SNAKE_WIDTH];
 	
+	if (!in_view(pt)) return(FALSE);
+	create_pixel_data(pt, pixel_data);
+
+	//Select pixel locations and draw
+	address_t display = pt2display(pt);
+	lcd_moveto_xy(display.page, display.column);
+	for (i=0; i < SNAKE_WIDTH; i++) {
+		lcd_data(pixel_data[i]);
+	}
+	lcd_bytes += LCD_MOVE_BYTES + SNAKE_WIDTH;
+	return(TRUE);
+}
+
+
+/*
+ * Function:  create_pixel_data
+ * -----------------------------
+ * Each LCD page holds two rows of the snake grid, so the pixels written for a 
+ * point also depend on the object above or below it. Transcribes both objects 
+ * from the wall buffer into the columns of pixels to be sent to the LCD.
+ *
+ *  pt: The position on the snake grid.
+ *  pixel_data: Filled in with SNAKE_WIDTH columns of pixels.
+ *
+ */
+void create_pixel_data(point_t pt, byte pixel_data[]) {
 	
 	// select applicable wall data
 	address_t loc = pt2bufferaddress(pt);
@@ -51,8 +87,10 @@ byte write_display(point_t pt) {
 	
 	// transcribe to pixel data
 	byte i, j, shift, pixel_shift;
-	byte pixel_data[SNAKE_WIDTH] = {0x00};
 	byte image_segment;
+	for (j=0; j<SNAKE_WIDTH; j++) {
+		pixel_data[j] = 0x00;
+	}
 	for (i=0; i<2; i++) {
 		pixel_shift = i*SNAKE_WIDTH;
 		shift = (offset + i*SNAKE_ROW_BIT_SIZE);
@@ -62,15 +100,92 @@ byte write_display(point_t pt) {
 			SET(pixel_data[j], (image_segment<<pixel_shift), ON);
 		}
 	}
+	return;
+}
 
 
-	//Select pixel locations and draw
-	address_t display = pt2display(pt);
-	lcd_moveto_xy(display.page, display.column);
-	for (i=0; i < SNAKE_WIDTH; i++) {
-		lcd_data(pixel_data[i]);
+/*
+ * Function:  draw_board
+ * ----------------------
+ * Redraws the whole game field from the wall buffer. The LCD moves on to the 
+ * next column by itself after every byte, so each page is sent in one run 
+ * with a single cursor move, rather than one move per point.
+ *
+ */
+void draw_board(void) {
+	byte i, page, pixel_data[SNAKE_WIDTH];
+	point_t pt;
+	
+	for (page = 0; page < MAX_SNAKE_DISPLAY_PAGE; page++) {
+		lcd_moveto_xy(page, 0);
+		pt.y = page*SNAKE_ROWS_PER_DISPLAY_PAGE;
+		for (pt.x = 0; pt.x < MAX_SNAKE_COLUMN; pt.x++) {
+			create_pixel_data(pt, pixel_data);
+			for (i=0; i < SNAKE_WIDTH; i++) {
+				lcd_data(pixel_data[i]);
+			}
+		}
+		lcd_bytes += LCD_MOVE_BYTES + MAX_SNAKE_COLUMN*SNAKE_WIDTH;
 	}
-	return(TRUE);
+	return;
+}
+
+/*
+ * Function:  draw_screen_column
+ * ------------------------------
+ * Redraws a single column of the game field from the wall buffer, after it
+ * has scrolled into view. A column crosses every page, so each of its pages
+ * needs a cursor move of its own.
+ *
+ *  column: The column on the screen, and of the wall buffer.
+ *
+ *  returns: The number of bytes sent to the LCD.
+ *
+ */
+uint8_t draw_screen_column(uint8_t column) {
+	byte i, page, pixel_data[SNAKE_WIDTH];
+	point_t pt;
+	
+	pt.x = column;
+	for (page = 0; page < MAX_SNAKE_DISPLAY_PAGE; page++) {
+		pt.y = page*SNAKE_ROWS_PER_DISPLAY_PAGE;
+		lcd_moveto_xy(page, SNAKE_WIDTH*column);
+		create_pixel_data(pt, pixel_data);
+		for (i=0; i < SNAKE_WIDTH; i++) {
+			lcd_data(pixel_data[i]);
+		}
+	}
+	lcd_bytes += MAX_SNAKE_DISPLAY_PAGE*(LCD_MOVE_BYTES + SNAKE_WIDTH);
+	return MAX_SNAKE_DISPLAY_PAGE*(LCD_MOVE_BYTES + SNAKE_WIDTH);
+}
+
+
+/*
+ * Function:  draw_screen_row
+ * ---------------------------
+ * Redraws a single row of the game field from the wall buffer, after it has
+ * scrolled into view. The page holding the row is sent in one run, which 
+ * also redraws the other row sharing that page.
+ *
+ *  row: The row on the screen, and of the wall buffer.
+ *
+ *  returns: The number of bytes sent to the LCD.
+ *
+ */
+uint8_t draw_screen_row(uint8_t row) {
+	byte i, pixel_data[SNAKE_WIDTH];
+	point_t pt;
+	
+	pt.y = row;
+	lcd_moveto_xy(row/SNAKE_ROWS_PER_DISPLAY_PAGE, 0);
+	for (pt.x = 0; pt.x < MAX_SNAKE_COLUMN; pt.x++) {
+		create_pixel_data(pt, pixel_data);
+		for (i=0; i < SNAKE_WIDTH; i++) {
+			lcd_data(pixel_data[i]);
+		}
+	}
+	lcd_bytes += LCD_MOVE_BYTES + MAX_SNAKE_COLUMN*SNAKE_WIDTH;
+	return LCD_MOVE_BYTES + MAX_SNAKE_COLUMN*SNAKE_WIDTH;
 }
 
 byte create_image(obj_t object, uint8_t idx) {
@@ -131,37 +246,54 @@ void draw_food(point_t pt) {
 }
 
 
+/*
+ * Function:  draw_minimap
+ * ------------------------
+ * Draws the board at a pixel per cell, in the top corner of the screen. Each 
+ * pair of pages of the walls buffer makes up one LCD page, a whole byte of 
+ * cells at a time.
+ *
+ */
 void draw_minimap(void) {
-	uint8_t i, elem, page, column;
-	byte mask, data, pixel_data = 0x00;
+	uint8_t page, column;
+	byte masks[MAX_SNAKE_PAGE], pixel_data;
+	
+	rect_masks(0, MAX_SNAKE_ROW, masks);
 	for (column=0; column<MAX_SNAKE_COLUMN; column++) {
-		for (page=0; page<MAX_SNAKE_PAGE; page++) {
-			data = walls[column][page];
-			for (i=0; i<4; i++) {
-				mask = 0b11 << 2*i;
-				elem = i + 4*(page%2);
-				if ((GET(data,mask)) != 0x00) {
-					SET(pixel_data, _BV(elem), ON);
-				} else {
-					SET(pixel_data, _BV(elem), OFF);
-				}
-			}
-			if (page%2 == 1 || (page == MAX_SNAKE_PAGE-1)) {
-				lcd_moveto_xy(page/2, column);
-				lcd_data(pixel_data);
-				pixel_data = 0x00;
-			}
+		for (page=0; page<MAX_SNAKE_PAGE; page+=2) {
+			pixel_data = pack_cells(~match_cells(walls[column][page], EMPTY) & masks[page]);
+			pixel_data |= pack_cells(~match_cells(walls[column][page+1], EMPTY) & masks[page+1]) << 4;
+			lcd_moveto_xy(page/2, column);
+			lcd_data(pixel_data);
 		}
 	}
 	return;
 }
 
-void write_score(uint8_t score) {
+void write_score(uint16_t score) {
 	lcd_moveto_xy(0,0);
 	lcd_put_int(check_free_ram());
-	lcd_moveto_xy(7,2);
+	lcd_moveto_xy(SCORE_PAGE,2);
 	lcd_putstr("score:");
-	lcd_moveto_xy(7,80);
+	lcd_moveto_xy(SCORE_PAGE,SCORE_COLUMN);
+	lcd_put_uint(score);
+	return;
+}
+
+
+/*
+ * Function:  write_player_score
+ * ------------------------------
+ * Writes one snake's score when several are playing. The line is split evenly
+ * between the snakes, in player order, which leaves four digits each for four.
+ *
+ *  index: The player.
+ *  count: The number of players.
+ *  score: The player's score.
+ *
+ */
+void write_player_score(uint8_t index, uint8_t count, uint16_t score) {
+	lcd_moveto_xy(SCORE_PAGE, index*(LCD_WIDTH/count));
 	lcd_put_uint(score);
 	return;
 }
@@ -0,0 +1,141 @@
+/*************************************************************************
+Title: FRAM Driver
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Reads and writes the SPI FRAM. The SPI peripheral is already set up by
+	lcd_init(), in mode 3, which the FRAM supports as well, so only the 
+	FRAM's own chip-select, write-protect and hold pins are set up here.
+
+	FRAM writes complete at bus speed, so there is no busy flag to poll, 
+	but every write must be preceded by its own write-enable.
+
+*************************************************************************/
+
+#include "console.h"
+#include "fram.h"
+
+fram_stats_t fram_stats = {0};
+
+
+/*
+ * Function:  fram_init
+ * ---------------------
+ * Deselects the FRAM and releases its hold and write-protect pins.
+ *
+ */
+void fram_init(void) {
+	FRAM_CHIP_DESELECT;
+	FRAM_HOLD_SET(OFF);
+	FRAM_WP_SET(OFF);
+	FRAM_CHIP_SELECT_DIR(OUT);
+	FRAM_HOLD_DIR(OUT);
+	FRAM_WP_DIR(OUT);
+	return;
+}
+
+
+/*
+ * Function:  fram_transfer
+ * -------------------------
+ * Exchanges one byte over SPI. Remember to chip-select first!
+ *
+ *  returns: The byte clocked in from the FRAM.
+ *
+ */
+byte fram_transfer(byte data) {
+	SPDR = data;
+	while (!SPI_TRANSFER_DONE);
+	return SPDR;
+}
+
+
+/*
+ * Function:  fram_begin
+ * ----------------------
+ * Selects the FRAM and sends an opcode followed by the address it applies to.
+ * The chip stays selected until the caller deselects it.
+ *
+ */
+void fram_begin(byte opcode, uint16_t address) {
+	FRAM_CHIP_SELECT;
+	fram_transfer(opcode);
+	fram_transfer(address >> 8);
+	fram_transfer(address & 0xFF);
+	return;
+}
+
+
+/*
+ * Function:  fram_read
+ * ---------------------
+ * Reads a block of consecutive bytes in a single transaction.
+ *
+ */
+void fram_read(uint16_t address, byte* data, uint16_t length) {
+	fram_begin(FRAM_READ, address);
+	fram_stats.reads++;
+	fram_stats.bytes_read += length;
+	while (length--) {
+		*data++ = fram_transfer(0x00);
+	}
+	FRAM_CHIP_DESELECT;
+	return;
+}
+
+
+/*
+ * Function:  fram_write
+ * ----------------------
+ * Writes a block of consecutive bytes in a single transaction.
+ *
+ */
+void fram_write(uint16_t address, const byte* data, uint16_t length) {
+	FRAM_CHIP_SELECT;
+	fram_transfer(FRAM_WRITE_ENABLE);
+	FRAM_CHIP_DESELECT;
+	
+	fram_begin(FRAM_WRITE, address);
+	fram_stats.writes++;
+	fram_stats.bytes_written += length;
+	while (length--) {
+		fram_transfer(*data++);
+	}
+	FRAM_CHIP_DESELECT;
+	return;
+}
+
+
+/*
+ * Function:  fram_fill
+ * ---------------------
+ * Sets a block of bytes to the same value, without a buffer to copy from.
+ *
+ */
+void fram_fill(uint16_t address, byte value, uint16_t length) {
+	FRAM_CHIP_SELECT;
+	fram_transfer(FRAM_WRITE_ENABLE);
+	FRAM_CHIP_DESELECT;
+	
+	fram_begin(FRAM_WRITE, address);
+	fram_stats.writes++;
+	fram_stats.bytes_written += length;
+	while (length--) {
+		fram_transfer(value);
+	}
+	FRAM_CHIP_DESELECT;
+	return;
+}
+
+byte fram_read_byte(uint16_t address) {
+	byte value;
+	fram_read(address, &value, 1);
+	return value;
+}
+
+void fram_write_byte(uint16_t address, byte value) {
+	fram_write(address, &value, 1);
+	return;
+}
@@ -0,0 +1,209 @@
+/*************************************************************************
+Title: Snake_Generate
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Procedural obstacle layouts, generated straight into the walls buffer
+	from a seed. No scratch memory is used besides a few locals: while the
+	reachable cells are being found, they are marked as SPECIAL in the 
+	buffer itself. The start rows are always left clear, since the snakes
+	set off along them.
+
+*************************************************************************/
+
+#include "console.h"
+#include "snake.h"
+#include "level.h"
+#include "board.h"
+
+static obj_t read_cell(int8_t x, int8_t y);
+static void write_cell(int8_t x, int8_t y, obj_t object);
+static void generate_rooms(uint16_t* state);
+static void generate_pillars(uint16_t* state);
+static void generate_maze(uint16_t* state);
+static bool spread_reachable(int8_t dx, int8_t dy);
+
+
+/*
+ * Function:  generate_level
+ * --------------------------
+ * Fills the walls buffer with a new layout, then walls off any empty cell that 
+ * could not be shown to be reachable from the start position. Food can only 
+ * be placed in empty cells, so every piece of food can then be reached. 
+ *
+ * The search for reachable cells gives up once GENERATE_BUDGET cycles have 
+ * passed. Any cells it has not reached by then are walled off as well, so the 
+ * layout is always safe to play, just with less open space.
+ *
+ *  layout: The kind of layout to generate.
+ *  seed: Any number; the same seed always gives the same layout.
+ *
+ *  returns: The number of empty cells that were walled off.
+ *
+ */
+uint16_t generate_level(layout_t layout, uint16_t seed) {
+	uint32_t start = get_cycles();
+	uint16_t state = (seed == 0) ? 1 : seed;
+	uint16_t walled;
+	uint8_t pass;
+	bool spreading = TRUE;
+	
+	switch (layout) {
+		case ROOMS:		generate_rooms(&state); break;
+		case PILLARS:	generate_pillars(&state); break;
+		case MAZE:		
+		default:		generate_maze(&state); break;
+	}
+	fill_rect(EMPTY, 0, START_Y-1, MAX_SNAKE_COLUMN, 4);
+	
+	// Flood out from the start, sweeping in each diagonal order in turn
+	write_cell(START_X, START_Y, SPECIAL);
+	for (pass = 0; spreading && pass < GENERATE_MAX_PASSES; pass++) {
+		if (get_cycles() - start > GENERATE_BUDGET) break;
+		spreading = spread_reachable(1, 1) | spread_reachable(-1, -1);
+		spreading |= spread_reachable(1, -1) | spread_reachable(-1, 1);
+	}
+	
+	walled = count_cells(EMPTY);
+	replace_cells(EMPTY, WALL);
+	replace_cells(SPECIAL, EMPTY);
+	return walled;
+}
+
+
+/*
+ * Function:  spread_reachable
+ * ----------------------------
+ * One sweep of the flood fill. An empty cell next to a reachable cell becomes 
+ * reachable itself. Sweeping in a given order carries the fill any distance 
+ * along a path heading that way, so only a few sweeps are needed for most 
+ * layouts. The edges wrap around, like they do for the snake.
+ *
+ *  dx, dy: The order of the sweep, 1 to go right/down or -1 to go left/up.
+ *
+ *  returns: True, if any cell became reachable.
+ *
+ */
+static bool spread_reachable(int8_t dx, int8_t dy) {
+	int8_t i, j, x, y;
+	bool spread = FALSE;
+	
+	for (i = 0; i < MAX_SNAKE_COLUMN; i++) {
+		x = (dx > 0) ? i : MAX_SNAKE_COLUMN-1-i;
+		for (j = 0; j < MAX_SNAKE_ROW; j++) {
+			y = (dy > 0) ? j : MAX_SNAKE_ROW-1-j;
+			if (read_cell(x, y) != EMPTY) continue;
+			if (read_cell(bound_check(x-1, 0, MAX_SNAKE_COLUMN), y) == SPECIAL ||
+				read_cell(bound_check(x+1, 0, MAX_SNAKE_COLUMN), y) == SPECIAL ||
+				read_cell(x, bound_check(y-1, 0, MAX_SNAKE_ROW)) == SPECIAL ||
+				read_cell(x, bound_check(y+1, 0, MAX_SNAKE_ROW)) == SPECIAL) {
+				write_cell(x, y, SPECIAL);
+				spread = TRUE;
+			}
+		}
+	}
+	return spread;
+}
+
+
+/*
+ * Function:  generate_rooms
+ * --------------------------
+ * A walled box split into four rooms by a horizontal and a vertical wall, with 
+ * a door through each of the four wall sections.
+ *
+ */
+static void generate_rooms(uint16_t* state) {
+	int8_t split_x = 4 + next_random(state) % (MAX_SNAKE_COLUMN-8);
+	int8_t split_y = 3 + next_random(state) % (MAX_SNAKE_ROW-6);
+	
+	fill_board(EMPTY);
+	fill_rect(WALL, 0, 0, MAX_SNAKE_COLUMN, 1);
+	fill_rect(WALL, 0, MAX_SNAKE_ROW-1, MAX_SNAKE_COLUMN, 1);
+	fill_rect(WALL, 0, split_y, MAX_SNAKE_COLUMN, 1);
+	fill_rect(WALL, 0, 0, 1, MAX_SNAKE_ROW);
+	fill_rect(WALL, MAX_SNAKE_COLUMN-1, 0, 1, MAX_SNAKE_ROW);
+	fill_rect(WALL, split_x, 0, 1, MAX_SNAKE_ROW);
+	
+	write_cell(1 + next_random(state) % (split_x-1), split_y, EMPTY);
+	write_cell(split_x+1 + next_random(state) % (MAX_SNAKE_COLUMN-split_x-2), split_y, EMPTY);
+	write_cell(split_x, 1 + next_random(state) % (split_y-1), EMPTY);
+	write_cell(split_x, split_y+1 + next_random(state) % (MAX_SNAKE_ROW-split_y-2), EMPTY);
+	return;
+}
+
+
+/*
+ * Function:  generate_pillars
+ * ----------------------------
+ * 2x2 pillars scattered over the open board. Pillars may overlap or close off 
+ * a pocket, which generate_level() then fills in.
+ *
+ */
+static void generate_pillars(uint16_t* state) {
+	uint8_t i;
+	int8_t x, y;
+	
+	fill_board(EMPTY);
+	for (i = 0; i < PILLAR_COUNT; i++) {
+		x = next_random(state) % (MAX_SNAKE_COLUMN-1);
+		y = next_random(state) % (MAX_SNAKE_ROW-1);
+		write_cell(x, y, WALL);
+		write_cell(x+1, y, WALL);
+		write_cell(x, y+1, WALL);
+		write_cell(x+1, y+1, WALL);
+	}
+	return;
+}
+
+
+/*
+ * Function:  generate_maze
+ * -------------------------
+ * A binary-tree maze. The cells of the maze sit on even columns and odd rows, 
+ * with walls in between. Every cell opens a passage either up or to the right,
+ * so every cell has a path to the top-right cell and the maze is connected.
+ *
+ */
+static void generate_maze(uint16_t* state) {
+	int8_t x, y;
+	bool up, right;
+	
+	fill_board(WALL);
+	for (x = 0; x < MAX_SNAKE_COLUMN; x += 2) {
+		for (y = 1; y < MAX_SNAKE_ROW; y += 2) {
+			write_cell(x, y, EMPTY);
+			up = (y > 1);
+			right = (x < MAX_SNAKE_COLUMN-1);
+			if (up && right) {
+				up = next_random(state) & 0x01;
+				right = !up;
+			}
+			if (up) write_cell(x, y-1, EMPTY);
+			if (right) write_cell(x+1, y, EMPTY);
+		}
+	}
+	return;
+}
+
+
+/*
+ * Function:  read_cell
+ * ---------------------
+ * Reads a cell of the walls buffer. Unlike is_wall(), the point must already be 
+ * on the board, which keeps the flood fill quick.
+ *
+ */
+static obj_t read_cell(int8_t x, int8_t y) {
+	byte shift = SNAKE_ROW_BIT_SIZE*(y % SNAKE_ROWS_PER_PAGE);
+	return GET(walls[x][y / SNAKE_ROWS_PER_PAGE] >> shift, 0b11);
+}
+
+static void write_cell(int8_t x, int8_t y, obj_t object) {
+	byte shift = SNAKE_ROW_BIT_SIZE*(y % SNAKE_ROWS_PER_PAGE);
+	SET(walls[x][y / SNAKE_ROWS_PER_PAGE], (0b11 << shift), (object << shift));
+	return;
+}
+
@@ -0,0 +1,247 @@
+/*************************************************************************
+Title: Input Latency
+Author: Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Measures how long the console takes to respond to an arrow key: from
+	the INT1 ISR of the press to the head of the snake being written to
+	the LCD in its new direction. A press is only acted on at the next
+	tick, so this is anywhere up to a whole tick, plus the time the tick
+	takes to reach the head.
+
+	A press is stamped with the cycle counter in the ISR. The game claims
+	the stamp when it polls the direction, and the latency is recorded
+	once it has drawn the head, if the press turned it. A reverse, or a
+	press of the way the snake is already going, is not timed. Presses
+	made while a tick is running are left for the next tick, as the game
+	would. Only the first press before a tick is timed, since it is the
+	one that has waited longest.
+
+	The latencies are kept as a histogram, which is shown by the latency
+	screen in the menu, and with -DTELEMETRY sent with every tick.
+
+	A-button: Back to the menu
+	B-button: Clear the histogram
+
+*************************************************************************/
+
+#include "console.h"
+#include "snake.h"
+#include "module.h"
+#include "latency.h"
+#include "dogm-graphic.h"
+
+latency_stats_t latency_stats = {.latest = LATENCY_NONE};
+static volatile uint32_t stamped_at;
+static volatile bool stamped = FALSE;
+static uint32_t claimed_at;
+static bool claimed = FALSE, redraw;
+
+const module_t latency_screen = {
+	"latency", LATENCY_POLL_MS, start_latency_screen, step_latency_screen, render_latency_screen,
+	end_latency_screen, describe_latency_screen, NULL
+};
+
+
+/*
+ * Function:  stamp_input
+ * -----------------------
+ * Stamps an arrow key press. Called from the INT1 ISR only. A press that
+ * has not yet been claimed keeps its stamp.
+ *
+ */
+void stamp_input(void) {
+	if (stamped) return;
+	stamped_at = get_cycles();
+	stamped = TRUE;
+	return;
+}
+
+
+/*
+ * Function:  claim_input
+ * -----------------------
+ * Takes the stamp of the press the game is about to act on, when it polls
+ * the arrow keys. Interrupts are held off so the ISR cannot stamp a press
+ * half-way through the copy.
+ *
+ */
+void claim_input(void) {
+	uint8_t sreg = SREG;
+
+	cli();
+	if (stamped) {
+		claimed_at = stamped_at;
+		claimed = TRUE;
+		stamped = FALSE;
+	}
+	SREG = sreg;
+	return;
+}
+
+
+/*
+ * Function:  drop_input
+ * ----------------------
+ * Forgets any press not yet recorded, e.g. one made in the menu.
+ *
+ */
+void drop_input(void) {
+	uint8_t sreg = SREG;
+
+	cli();
+	stamped = FALSE;
+	claimed = FALSE;
+	SREG = sreg;
+	return;
+}
+
+
+/*
+ * Function:  record_latency
+ * --------------------------
+ * Adds the latency of the claimed press to the histogram, once the head has
+ * been written to the LCD. Does nothing if no press was claimed. A press
+ * that did not turn the head, e.g. a reverse or the current direction, is
+ * let go without being timed.
+ *
+ *  turned: True, if the head moved off in a new direction this tick.
+ *
+ */
+void record_latency(bool turned) {
+	uint32_t cycles;
+	uint16_t ms;
+	uint8_t bin;
+
+	if (!claimed) return;
+	claimed = FALSE;
+	if (!turned) return;
+	cycles = get_cycles() - claimed_at;
+	ms = (cycles / CYCLES_PER_MS < LATENCY_NONE) ? cycles / CYCLES_PER_MS : LATENCY_NONE - 1;
+
+	bin = (ms / LATENCY_BIN_MS < LATENCY_BINS) ? ms / LATENCY_BIN_MS : LATENCY_BINS - 1;
+	if (latency_stats.bins[bin] < 0xFFFF) latency_stats.bins[bin]++;
+	if (latency_stats.count < 0xFFFF) latency_stats.count++;
+	if (ms > latency_stats.worst) latency_stats.worst = ms;
+	latency_stats.total += ms;
+	latency_stats.latest = ms;
+	return;
+}
+
+void reset_latency(void) {
+	latency_stats = (latency_stats_t){.latest = LATENCY_NONE};
+	return;
+}
+
+
+/*
+ * Function:  start_latency_screen
+ * --------------------------------
+ * The init() of the latency screen. Nothing changes while it is shown, so
+ * it is only drawn again once the histogram has been cleared.
+ *
+ */
+void start_latency_screen(void) {
+	redraw = TRUE;
+	return;
+}
+
+bool step_latency_screen(void) {
+	switch (pop_input()) {
+		case BUTTON_A:
+			return FALSE;
+		case BUTTON_B:
+			reset_latency();
+			redraw = TRUE;
+			break;
+		default:
+			break;
+	}
+	return TRUE;
+}
+
+
+/*
+ * Function:  render_latency_screen
+ * ---------------------------------
+ * Draws the histogram, with a bar per LATENCY_BIN_MS scaled to the tallest
+ * bar, between the number of presses measured and their mean and worst
+ * latency in ms.
+ *
+ */
+void render_latency_screen(void) {
+	uint16_t tallest = 1;
+	uint8_t bin, height;
+
+	if (!redraw) return;
+	redraw = FALSE;
+
+	LCD_clear();
+	lcd_moveto_xy(0, 0);
+	lcd_putstr("latency");
+	lcd_moveto_xy(0, 70);
+	lcd_put_uint(latency_stats.count);
+
+	for (bin = 0; bin < LATENCY_BINS; bin++) {
+		if (latency_stats.bins[bin] > tallest) tallest = latency_stats.bins[bin];
+	}
+	for (bin = 0; bin < LATENCY_BINS; bin++) {
+		height = (uint32_t)latency_stats.bins[bin]*LATENCY_BAR_HEIGHT / tallest;
+		if (height == 0 && latency_stats.bins[bin] != 0) height = 1; // Keep rare latencies visible
+		draw_latency_bar(bin, height);
+	}
+
+	lcd_moveto_xy(7, 0);
+	lcd_putstr("avg");
+	lcd_moveto_xy(7, 24);
+	lcd_put_uint(latency_stats.count ? latency_stats.total / latency_stats.count : 0);
+	lcd_moveto_xy(7, 54);
+	lcd_putstr("max");
+	lcd_moveto_xy(7, 78);
+	lcd_put_uint(latency_stats.worst);
+	return;
+}
+
+
+/*
+ * Function:  draw_latency_bar
+ * ----------------------------
+ * Draws a bar of the histogram, up from the bottom of LATENCY_LAST_PAGE,
+ * with a blank column to the right of it. The top pixel of a page is its
+ * lowest bit.
+ *
+ *  bin: The bar, from the left.
+ *  height: In pixels, up to LATENCY_BAR_HEIGHT.
+ *
+ */
+void draw_latency_bar(uint8_t bin, uint8_t height) {
+	uint8_t page, i, filled, bottom;
+	byte data;
+
+	for (page = LATENCY_FIRST_PAGE; page <= LATENCY_LAST_PAGE; page++) {
+		bottom = (LATENCY_LAST_PAGE - page)*PIXEL_PER_PAGE;
+		filled = (height > bottom) ? height - bottom : 0;
+		if (filled > PIXEL_PER_PAGE) filled = PIXEL_PER_PAGE;
+		data = (byte)(0xFF << (PIXEL_PER_PAGE - filled));
+
+		lcd_moveto_xy(page, bin*LATENCY_BAR_WIDTH);
+		for (i = 0; i < LATENCY_BAR_WIDTH - 1; i++) {
+			lcd_data(data);
+		}
+		lcd_data(0x00);
+	}
+	return;
+}
+
+void end_latency_screen(void) {
+	LCD_clear();
+	return;
+}
+
+void describe_latency_screen(telemetry_t* frame) {
+	frame->length = 0;
+	frame->segments = 0;
+	return;
+}
@@ -0,0 +1,183 @@
+/*************************************************************************
+Title: Snake_Level
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Obstacle maps for the game field. The maps are kept in flash, run-length
+	encoded over the 2-bit cells of the walls buffer, and decoded straight 
+	into it. They are generated from tools/levels.txt by tools/level_encode.py,
+	which describes the format.
+
+*************************************************************************/
+
+#include <string.h>
+#include "console.h"
+#include "snake.h"
+#include "level.h"
+#include "world.h"
+
+uint32_t level_load_cycles = 0;
+
+
+/*
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ */
+static const byte level_open[] PROGMEM = {
+	0x0F, 0xD7,
+};	// 2 bytes
+
+/*
+ *	#########################
+ *	#.......................#
+ *	#.......................#
+ *	#.......................#
+ *	#.......................#
+ *	#.......................#
+ *	.........................
+ *	.........................
+ *	.........................
+ *	#.......................#
+ *	#.......................#
+ *	#.......................#
+ *	#.......................#
+ *	#########################
+ */
+static const byte level_box[] PROGMEM = {
+	0x45, 0x02, 0x44, 0x01, 0x40, 0x0B, 0x40, 0x01, 0xD5, 0x45, 0x02, 0x44,
+	0x01,
+};	// 13 bytes
+
+/*
+ *	.........................
+ *	.........................
+ *	...##.....##.....##......
+ *	...##.....##.....##......
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	...##.....##.....##......
+ *	...##.....##.....##......
+ *	.........................
+ *	.........................
+ */
+static const byte level_pillars[] PROGMEM = {
+	0x0F, 0xC1, 0x01, 0x41, 0x05, 0x41, 0x03, 0xC0, 0x0F, 0xC3, 0x01, 0x41,
+	0x05, 0x41, 0x03, 0xC0, 0x0F, 0xC3, 0x01, 0x41, 0x05, 0x41, 0x03, 0xC0,
+	0x0F, 0xC4,
+};	// 26 bytes
+
+/*
+ *	.........................
+ *	.........................
+ *	.........................
+ *	....#################....
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	.........................
+ *	....#################....
+ *	.........................
+ *	.........................
+ *	.........................
+ */
+static const byte level_bars[] PROGMEM = {
+	0x0F, 0xC2, 0x02, 0x40, 0x05, 0x40, 0x04, 0xCF, 0x0F, 0xC2,
+};	// 10 bytes
+
+static const byte* const level_maps[MAP_COUNT] = {
+	level_open, level_box, level_pillars, level_bars
+};
+
+
+/*
+ * Function:  load_level
+ * ----------------------
+ * Replaces the game field with one of the level maps and redraws it. The levels
+ * after the stored maps are generated, one per layout, from a seed taken from 
+ * rand(). The level is then tiled over every screen of the world in FRAM.
+ * The time taken is kept in level_load_cycles, and should stay well under a
+ * tick so that a new level can be shown between games without a visible pause.
+ *
+ *  level: The index of the level, wrapping around after LEVEL_COUNT.
+ *
+ */
+void load_level(uint8_t level) {
+	uint32_t start = get_cycles();
+	level %= LEVEL_COUNT;
+	reset_view();
+	if (level < MAP_COUNT) {
+		decode_level(level_maps[level]);
+	} else {
+		generate_level(level - MAP_COUNT, rand());
+	}
+	store_world();
+	draw_board();
+	level_load_cycles = get_cycles() - start;
+	return;
+}
+
+
+/*
+ * Function:  decode_level
+ * ------------------------
+ * Streams a map out of flash into the walls buffer, one whole byte at a time 
+ * where a run allows it. A run of REPEAT_COLUMN copies the column before it,
+ * and only ever starts on a column boundary.
+ *
+ *  map: The encoded map, in flash.
+ *
+ */
+void decode_level(const byte* map) {
+	byte* buffer = (byte*)walls;
+	byte code, object, length, data = 0x00;
+	uint16_t cell = 0;
+	
+	while (cell < LEVEL_CELLS) {
+		code = pgm_read_byte(map++);
+		object = RUN_OBJECT(code);
+		length = RUN_LENGTH(code);
+		
+		if (object == REPEAT_COLUMN) {
+			for (; length > 0; length--, cell += CELLS_PER_COLUMN) {
+				memcpy(&buffer[cell/CELLS_PER_BYTE], &buffer[cell/CELLS_PER_BYTE - MAX_SNAKE_PAGE], MAX_SNAKE_PAGE);
+			}
+			continue;
+		}
+		
+		for (; length > 0; length--, cell++) {
+			// Whole bytes of the same object are written in one go
+			if (cell % CELLS_PER_BYTE == 0 && length >= CELLS_PER_BYTE) {
+				buffer[cell/CELLS_PER_BYTE] = FILL_PATTERN(object);
+				length -= CELLS_PER_BYTE - 1;
+				cell += CELLS_PER_BYTE - 1;
+				continue;
+			}
+			data |= object << (SNAKE_ROW_BIT_SIZE*(cell % CELLS_PER_BYTE));
+			if (cell % CELLS_PER_BYTE == CELLS_PER_BYTE - 1) {
+				buffer[cell/CELLS_PER_BYTE] = data;
+				data = 0x00;
+			}
+		}
+	}
+	return;
+}
@@ -0,0 +1,299 @@
+/*************************************************************************
+Title: Game Modules
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Runs games as modules: a table of init, tick, render and teardown
+	functions, picked from a menu. Rather than every game bringing its 
+	own, the console shares a few statically allocated services between
+	them, so switching games takes no heap and never re-initialises the 
+	LCD:
+
+	  - the walls buffer, as the framebuffer of 2-bit cells drawn to the 
+	    LCD by draw.c. A pixel framebuffer would not fit in 1 KB of SRAM.
+	  - an input queue, filled with button presses by the INT1 ISR. Snake
+	    steers from it, and the menus are driven by it. The arrow keys
+	    are also timed until the game responds, see latency.c.
+	  - a tick scheduler, which paces ticks on the cycle counter, so the
+	    time a tick takes is not added on top of the delay between ticks.
+	  - the flight recorder, which is moved on a tick after every tick, 
+	    and logs ticks that ran over, see recorder.c.
+	  - telemetry, with -DTELEMETRY. A frame is queued after every tick,
+	    timing its tick() and render(), see telemetry.c.
+
+	Arrow keys: Move through the menu
+	A-button: Start the game
+
+*************************************************************************/
+
+#include "console.h"
+#include "snake.h"
+#include "module.h"
+#include "latency.h"
+#include "recorder.h"
+#include "dogm-graphic.h"
+
+byte walls[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE] = {{ OFF }};
+static volatile button_t input_queue[INPUT_QUEUE_SIZE];
+static volatile uint8_t input_head = 0, input_tail = 0;
+static uint32_t tick_period, next_tick;
+#ifdef TELEMETRY
+static telemetry_t frame;
+#endif
+
+const module_t* const modules[MODULE_COUNT] = {
+	&solo_snake, &versus_snake, &duel_snake, &latency_screen
+};
+
+
+/*
+ * Function:  run_module
+ * ----------------------
+ * Plays a game from start to finish, one tick at a time. A game that can be 
+ * restarted shows the game over screen over its last tick, and is played again
+ * from there for as long as the player asks.
+ *
+ */
+void run_module(const module_t* module) {
+	enter_module(module);
+	while (TRUE) {
+		wait_for_tick();
+		if (run_tick(module)) continue;
+		if (module->restart == NULL || !display_game_over_screen()) break;
+		restart_module(module);
+	}
+	leave_module(module);
+	return;
+}
+
+
+/*
+ * Function:  run_tick
+ * --------------------
+ * Runs a single tick of a game and renders it. With -DTELEMETRY, the tick is 
+ * timed and its telemetry frame queued afterwards, so that sending it is not
+ * part of what it measures.
+ *
+ *  returns: False, once the game is over.
+ *
+ */
+bool run_tick(const module_t* module) {
+#ifdef TELEMETRY
+	uint32_t start = get_cycles();
+	uint32_t spi_bytes = spi_bytes_sent();
+	
+	latency_stats.latest = LATENCY_NONE;
+	if (!module->tick()) return FALSE;
+	frame.logic_cycles = get_cycles() - start;
+	frame.latency = latency_stats.latest;
+	module->render();
+	frame.render_cycles = get_cycles() - start - frame.logic_cycles;
+	frame.spi_bytes = spi_bytes_sent() - spi_bytes;
+	frame.free_ram = check_free_ram();
+	module->describe(&frame);
+	
+	if (frame.tick % TELEMETRY_INTERVAL == 0) send_telemetry(&frame);
+	frame.tick++;
+#else
+	if (!module->tick()) return FALSE;
+	module->render();
+#endif
+	record_tick();
+	return TRUE;
+}
+
+
+/*
+ * Function:  enter_module
+ * ------------------------
+ * Starts a game on a clean slate: no presses left over from the menu, and the
+ * first tick a whole period away.
+ *
+ */
+void enter_module(const module_t* module) {
+#ifdef TELEMETRY
+	frame.tick = 0;
+#endif
+	flush_input();
+	module->init();
+	module->render();
+	start_ticks(module->tick_ms);
+	return;
+}
+
+void leave_module(const module_t* module) {
+	module->teardown();
+	flush_input();
+	return;
+}
+
+void restart_module(const module_t* module) {
+#ifdef TELEMETRY
+	frame.tick = 0;
+#endif
+	flush_input();
+	module->restart();
+	module->render();
+	start_ticks(module->tick_ms);
+	return;
+}
+
+
+/*
+ * Function:  run_menu
+ * --------------------
+ * Lists the games and waits for one to be picked. The first time, once 
+ * the list is on screen, the console's initialisation is finished.
+ *
+ *  returns: The module picked.
+ *
+ */
+const module_t* run_menu(void) {
+	uint8_t item = 0;
+	
+	draw_menu(item);
+	finish_game_console();
+	
+	flush_input();
+	while (TRUE) {
+		switch (pop_input()) {
+			case BUTTON_UP:
+				draw_menu_cursor(item, ' ');
+				item = (item + MODULE_COUNT - 1) % MODULE_COUNT;
+				draw_menu_cursor(item, '>');
+				break;
+			case BUTTON_DOWN:
+				draw_menu_cursor(item, ' ');
+				item = (item + 1) % MODULE_COUNT;
+				draw_menu_cursor(item, '>');
+				break;
+			case BUTTON_A:
+				LCD_clear();
+				return modules[item];
+			case BUTTON_NONE:
+				_delay_ms(MENU_POLL_MS);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void draw_menu(uint8_t item) {
+	uint8_t i;
+	
+	LCD_clear();
+	lcd_moveto_xy(0, MENU_COLUMN);
+	lcd_putstr("GAMES");
+	for (i = 0; i < MODULE_COUNT; i++) {
+		lcd_moveto_xy(MENU_FIRST_PAGE + i, MENU_COLUMN);
+		lcd_putstr(modules[i]->name);
+	}
+	draw_menu_cursor(item, '>');
+	return;
+}
+
+void draw_menu_cursor(uint8_t item, char cursor) {
+	lcd_moveto_xy(MENU_FIRST_PAGE + item, 0);
+	lcd_putc(cursor);
+	return;
+}
+
+
+/*
+ * Function:  start_ticks
+ * -----------------------
+ * Sets the tick period, and starts counting the first tick from now.
+ *
+ */
+void start_ticks(uint16_t period_ms) {
+	tick_period = (uint32_t)period_ms*CYCLES_PER_MS;
+	next_tick = get_cycles() + tick_period;
+	return;
+}
+
+
+/*
+ * Function:  set_tick_period
+ * ---------------------------
+ * Changes the tick period part-way through a game, e.g. to speed it up. The
+ * tick already being waited for keeps its start.
+ *
+ */
+void set_tick_period(uint16_t period_ms) {
+	tick_period = (uint32_t)period_ms*CYCLES_PER_MS;
+	return;
+}
+
+
+/*
+ * Function:  wait_for_tick
+ * -------------------------
+ * Waits for the start of the next tick. If a tick ran over, the next one 
+ * starts straight away, but the missed ticks are dropped rather than run back
+ * to back to catch up. Overruns are logged by the flight recorder, in ms.
+ *
+ */
+void wait_for_tick(void) {
+	uint32_t now = get_cycles();
+	uint32_t late = now - next_tick;
+	
+	if ((int32_t)late > 0) {
+		late /= CYCLES_PER_MS;
+		record_event(REC_OVERRUN, 0, late < EVENT_VALUE_CAP ? late : EVENT_VALUE_CAP);
+	}
+	if ((int32_t)(now - next_tick) > (int32_t)tick_period) {
+		next_tick = now;
+	}
+	while ((int32_t)(get_cycles() - next_tick) < 0);
+	next_tick += tick_period;
+	return;
+}
+
+
+/*
+ * Function:  push_input
+ * ----------------------
+ * Queues a button press. Called from the INT1 ISR, or by the scripted players
+ * of the benchmarks while the buttons are left alone, so the head index has 
+ * a single writer and the queue needs no locking. Presses are dropped while 
+ * the queue is full.
+ *
+ */
+void push_input(button_t button) {
+	uint8_t next = (input_head + 1) % INPUT_QUEUE_SIZE;
+	if (next == input_tail) return;
+	input_queue[input_head] = button;
+	input_head = next;
+	return;
+}
+
+
+/*
+ * Function:  pop_input
+ * ---------------------
+ *  returns: The oldest button press in the queue, or BUTTON_NONE.
+ *
+ */
+button_t pop_input(void) {
+	button_t button;
+	if (input_tail == input_head) return BUTTON_NONE;
+	button = input_queue[input_tail];
+	input_tail = (input_tail + 1) % INPUT_QUEUE_SIZE;
+	return button;
+}
+
+
+/*
+ * Function:  flush_input
+ * -----------------------
+ * Drops every press not yet popped, so none are timed for latency either.
+ *
+ */
+void flush_input(void) {
+	input_tail = input_head;
+	drop_input();
+	return;
+}
@@ -12,15 +12,49 @@ DESCRIPTION:
 
 	Arrow keys: Move direction
 	A-button: Clear screen
-	B-button: Change brightness
+	B-button: Change brightness, or hold to rewind the solo game
 
 *************************************************************************/
 
 #include "console.h"
 #include "snake.h"
+#include "level.h"
+#include "world.h"
+#include "fram.h"
+#include "module.h"
+#include "latency.h"
+#include "recorder.h"
+#include "rewind.h"
+#include "board.h"
+#include "dogm-graphic.h"
 
-volatile byte walls[MAX_SNAKE_COLUMN][MAX_SNAKE_PAGE] = {{ OFF }};
-extern direction_t selected_direction;
+extern volatile int8_t action_turn;
+extern volatile byte action_steering;
+extern volatile byte action_rewind;
+static player_t players[MAX_SNAKES];
+static point_t food[MAX_SNAKES];
+static uint8_t player_count;
+static uint8_t level = 0;
+static uint16_t food_random = 1;	// See seed_food()
+
+// Rows START_Y-1 to START_Y+1 are clear all the way across in every level
+static const point_t start_positions[MAX_SNAKES] = {
+	{START_X, START_Y}, {START_X, START_Y+1}, {START_X, START_Y-1}, {START_X+1, START_Y-1}
+};
+static const direction_t start_directions[MAX_SNAKES] = {RIGHT, LEFT, LEFT, RIGHT};
+
+const module_t solo_snake = {
+	"snake", SPEED, start_solo_snake, step_snake_game, render_snake_game, end_snake_game, 
+	describe_snake_game, restart_snake_game
+};
+const module_t versus_snake = {
+	"snake vs cpu", SPEED, start_versus_snake, step_snake_game, render_snake_game, end_snake_game,
+	describe_snake_game, restart_snake_game
+};
+const module_t duel_snake = {
+	"2 players", SPEED, start_duel_snake, step_snake_game, render_snake_game, end_snake_game,
+	describe_snake_game, restart_snake_game
+};
 
 
 /*
@@ -53,52 +87,468 @@ extern direction_t selected_direction;
  *
  */
 void play_snake_game() {
-	point_t tail, head = {.x = START_X, .y = START_Y};
-	direction_t direction = RIGHT;
-	snake_t* snake = create_snake(head, direction);
-	point_t food = generate_food();
-	
-	while (TRUE) {
-		direction = update_direction(direction);
-		head = add_to_head(snake, direction); 
-		food = check_food_collision(snake, food);
-		if (is_wall(head))  break;
-		
-		// Only draw head once the collision has been checked
-		draw(head);
-		write_score(snake->length);  
-		while (snake->length >= snake->max_length) {
-			tail = remove_from_tail(snake);
-			clear(tail);
+	run_module(&solo_snake);
+}
+
+
+/*
+ * Function:  start_solo_snake
+ * ----------------------------
+ * The init() of each snake module. Several snakes can share the board, e.g. two 
+ * players, or a player against the AI. The game is over once every player 
+ * steering from the buttons has crashed.
+ *
+ */
+void start_solo_snake(void) {
+	static const input_t inputs[] = {BUTTONS};
+	start_snake_game(1, inputs);
+}
+
+void start_versus_snake(void) {
+	static const input_t inputs[] = {BUTTONS, AI};
+	start_snake_game(2, inputs);
+}
+
+void start_duel_snake(void) {
+	static const input_t inputs[] = {BUTTONS, ACTION_BUTTONS};
+	start_snake_game(2, inputs);
+}
+
+
+/*
+ * Function:  start_snake_game
+ * ----------------------------
+ * Loads the next level, then places the snakes and one food per snake on the board.
+ * The snakes themselves are statically allocated. Their segments still come from
+ * the heap, a node per turn, unless the stream body is built, see RULE_BODY.
+ *
+ *  count: The number of snakes, up to MAX_SNAKES.
+ *  inputs: Where each snake takes its directions from.
+ *
+ */
+void start_snake_game(uint8_t count, const input_t inputs[]) {
+	uint8_t i;
+	
+	record_event(REC_START, count, level);
+	load_level(level++);
+	player_count = count;
+	for (i = 0; i < count; i++) {
+		players[i].input = inputs[i];
+	}
+	place_snakes();
+	return;
+}
+
+
+/*
+ * Function:  restart_snake_game
+ * ------------------------------
+ * The restart() of each snake module, to play again from the game over screen
+ * on the same level with the same players. Rather than tearing the game down
+ * and loading the level again, only what is lit on top of the level is erased:
+ * the cells of the snakes and the food, the game over text and the score. 
+ * Every screen of the world holds the same level, so the view can jump back 
+ * to the start without reloading the walls buffer. The snakes' nodes are kept
+ * for the new snakes, see recycle_snake().
+ *
+ */
+void restart_snake_game(void) {
+	uint8_t i, page;
+	player_t* player;
+	
+	for (i = 0; i < player_count; i++) {
+		player = &players[i];
+		erase_snake(&player->snake, player->alive);
+		recycle_snake(&player->snake);
+		if (food[i].x >= 0) clear(food[i]);
+	}
+	reset_view();
+	for (page = GAME_OVER_FIRST_PAGE; page <= GAME_OVER_LAST_PAGE; page++) {
+		draw_screen_row(page*SNAKE_ROWS_PER_DISPLAY_PAGE);
+	}
+	if (player_count == 1) {
+		lcd_clear_area_xy(1, LCD_WIDTH - SCORE_COLUMN, NORMAL, SCORE_PAGE, SCORE_COLUMN);
+	} else {
+		lcd_clear_area_xy(1, LCD_WIDTH, NORMAL, SCORE_PAGE, 0);
+	}
+	
+	record_event(REC_START, player_count, level - 1);
+	place_snakes();
+	return;
+}
+
+
+/*
+ * Function:  place_snakes
+ * ------------------------
+ * Puts the snakes at their start positions on the level, each steered from its
+ * player's input, and one food per snake on the board.
+ *
+ */
+void place_snakes(void) {
+	uint8_t i;
+	player_t* player;
+	
+	action_steering = FALSE;
+	action_rewind = (player_count == 1);
+	clear_deltas();
+	for (i = 0; i < player_count; i++) {
+		player = &players[i];
+		player->dir = start_directions[i];
+		player->alive = TRUE;
+		create_snake(&player->snake, start_positions[i], player->dir);
+		player->score = player->snake.length;
+		if (player->input == ACTION_BUTTONS) action_steering = TRUE;
+	}
+	for (i = 0; i < player_count; i++) {
+		food[i] = generate_food();
+	}
+	action_turn = 0;
+	return;
+}
+
+
+/*
+ * Function:  step_snake_game
+ * ---------------------------
+ * Advances the game by a single tick. Every snake moves one step in the direction
+ * from its input, eats any food in its way and loses its tail if it has grown too
+ * long. The cell a head moves into is only looked up once, see enter_cell().
+ * A snake crashes if its head runs into a wall or any snake's body, or if two
+ * heads move into the same cell. Crashed snakes are cleared off the board.
+ *
+ * Each snake is visited a fixed number of times, so a tick costs time in proportion
+ * to the number of snakes. Only the head-to-head check compares snakes pairwise, 
+ * which for MAX_SNAKES snakes is a handful of comparisons.
+ *
+ * In the solo game, the delta of every tick is kept so that it can be undone, and
+ * while the B-button is held the game is rewound instead, see rewind.c.
+ *
+ *  returns: False, once the game is over.
+ *
+ */
+bool step_snake_game(void) {
+	uint8_t i, j;
+	player_t* player;
+	point_t tail;
+	direction_t dir;
+	byte delta = 0;
+	byte head_on = 0, turned = 0;	// A bit per player
+	
+	if (action_rewind && ACTION_B_BUTTON) {
+		for (i = 0; i < REWIND_SPEED && rewind_snake_game(); i++);
+		return TRUE;
+	}
+	
+	for (i = 0; i < player_count; i++) {
+		player = &players[i];
+		if (!player->alive) continue;
+		dir = next_direction(player, i);
+		if (dir != player->dir) {
+			record_event(REC_TURN, i, dir);
+			turned |= _BV(i);
+		}
+		player->dir = dir;
+		player->next = next_pos(get_head_position(&player->snake), player->dir);
+	}
+	
+	// Scroll first, so the first player's head is always checked and drawn in view
+	if (players[0].alive && !OFF_WORLD(players[0].next)) follow(players[0].next);
+	// Heads meeting in a cell all crash, so every one is found before any is killed
+	for (i = 0; i < player_count; i++) {
+		for (j = i+1; j < player_count; j++) {
+			if (players[i].alive && players[j].alive && equal_pts(players[i].next, players[j].next)) {
+				head_on |= _BV(i) | _BV(j);
+			}
+		}
+	}
+	for (i = 0; i < player_count; i++) {
+		if (!(head_on & _BV(i))) continue;
+		players[i].alive = FALSE;
+		record_event(REC_CRASH, i, CRASH_HEAD);
+		add_to_head(&players[i].snake, players[i].dir);
+	}
+	
+	for (i = 0; i < player_count; i++) {
+		player = &players[i];
+		if (!player->alive) continue;
+		add_to_head(&player->snake, player->dir);
+		switch (enter_cell(player->next)) {
+			case FOOD:
+				eat_food(&player->snake, player->next);
+				record_event(REC_LENGTH, i,
+					player->snake.max_length < EVENT_VALUE_CAP ? player->snake.max_length : EVENT_VALUE_CAP);
+				delta |= DELTA_ATE;
+#if RULE_SPEED == SPEED_RAMP
+				if (i == 0) set_tick_period(RAMP_PERIOD(player->snake.max_length));
+#endif
+				break;
+			case WALL:
+			case SPECIAL:
+				player->alive = FALSE;
+				record_event(REC_CRASH, i, CRASH_WALL);
+				continue;
+			case EMPTY:
+			default:
+				break;
 		}
-		//draw_minimap();
+		if (player->input == BUTTONS) record_latency(turned & _BV(i));
+	}
+	if (game_over()) return FALSE;
+	
+	for (i = 0; i < player_count; i++) {
+		player = &players[i];
+		if (player->alive) {
+			while (player->snake.length >= player->snake.max_length) {
+				delta |= DELTA_TAIL | DELTA_TAIL_DIR(get_tail_direction(&player->snake));
+				tail = remove_from_tail(&player->snake);
+				clear(tail);
+			}
+		} else if (!is_empty_snake(&player->snake)) {
+			// The new head was never drawn, so only the rest of the snake is cleared
+			while (player->snake.length > 1) {
+				clear(remove_from_tail(&player->snake));
+			}
+			clear_snake(&player->snake);
+		}
+	}
+	if (player_count == 1) push_delta(delta);
+	//draw_minimap();
+	return TRUE;
+}
 
-		// Pause before drawing next pixel
-		_delay_ms(SPEED); 
+
+/*
+ * Function:  rewind_snake_game
+ * -----------------------------
+ * Undoes the last tick of the solo game, in the reverse order it was played: 
+ * the tail cell is put back, then the head taken off, and any food it ate put
+ * back in place of the food that replaced it. Only the cells that changed are
+ * redrawn, and the view follows the head back.
+ *
+ *  returns: False, once the history has run out.
+ *
+ */
+bool rewind_snake_game(void) {
+	player_t* player = &players[0];
+	byte delta = pop_delta();
+	point_t head;
+	
+	if (delta == NO_DELTA) return FALSE;
+	if (delta & DELTA_TAIL) {
+		draw(add_to_tail(&player->snake, DELTA_GET_TAIL_DIR(delta)));
+	}
+	head = remove_from_head(&player->snake);
+	if (delta & DELTA_ATE) {
+		decrease_length(&player->snake);
+#if RULE_SPEED == SPEED_RAMP
+		set_tick_period(RAMP_PERIOD(player->snake.max_length));
+#endif
+		clear(food[0]);
+		food[0] = head;
+		draw_food(head);
+	} else {
+		clear(head);
 	}
 	
-	end_snake_game(snake);
+	player->dir = get_head_direction(&player->snake);
+	flush_input(); // Carry on straight once B is let go
+	follow(get_head_position(&player->snake));
+	return TRUE;
 }
 
-direction_t update_direction(direction_t current) {
-	direction_t update = current;
-	switch (selected_direction) {
-		case UP:
-			if (current != DOWN) update = UP;
-			break;
-		case DOWN:
-			if (current != UP) update = DOWN;
-			break;
-		case LEFT:
-			if (current != RIGHT) update = LEFT;
-			break;
-		case RIGHT:
-			if (current != LEFT) update = RIGHT;
-			break;
-		case NONE:
+
+/*
+ * Function:  render_snake_game
+ * -----------------------------
+ * The snakes are drawn cell by cell as they move, so only the score is left
+ * to draw after a tick. With more than one snake, each snake's length is shown,
+ * held at what it was when the snake crashed.
+ *
+ */
+void render_snake_game(void) {
+	uint8_t i;
+	
+	if (player_count == 1) {
+		write_score(players[0].snake.length);
+		return;
+	}
+	for (i = 0; i < player_count; i++) {
+		if (players[i].alive) players[i].score = players[i].snake.length;
+		write_player_score(i, player_count, players[i].score);
+	}
+	return;
+}
+
+
+/*
+ * Function:  describe_snake_game
+ * -------------------------------
+ * Adds the first snake's length, and the number of heap nodes it is made of, 
+ * to the telemetry of a tick.
+ *
+ */
+void describe_snake_game(telemetry_t* frame) {
+	frame->length = players[0].snake.length < UINT8_MAX ? players[0].snake.length : UINT8_MAX;
+	frame->segments = count_segments(&players[0].snake);
+	return;
+}
+
+
+/*
+ * Function:  game_over
+ * ---------------------
+ * The game carries on while any snake steered by a player is alive. With no 
+ * players, e.g. when the AI plays itself, it carries on while any snake is alive.
+ * It is won, and over, once the view is full and no more food can be placed.
+ *
+ */
+bool game_over(void) {
+	uint8_t i;
+	bool any_alive = FALSE, any_players = FALSE;
+	
+	for (i = 0; i < player_count; i++) {
+		if (food[i].x < 0) return TRUE;
+	}
+	for (i = 0; i < player_count; i++) {
+		if (players[i].input != AI) {
+			any_players = TRUE;
+			if (players[i].alive) return FALSE;
+		}
+		any_alive |= players[i].alive;
+	}
+	return any_players || !any_alive;
+}
+
+
+/*
+ * Function:  get_snake
+ * ---------------------
+ *  returns: The snake of the given player.
+ *
+ */
+snake_t* get_snake(uint8_t player) {
+	return &players[player].snake;
+}
+
+point_t get_food(uint8_t player) {
+	return food[player];
+}
+
+
+/*
+ * Function:  select_level
+ * ------------------------
+ * Picks the level the next game is played on. Each new game otherwise moves on
+ * to the level after the last.
+ *
+ */
+void select_level(uint8_t number) {
+	level = number;
+	return;
+}
+
+
+/*
+ * Function:  next_direction
+ * --------------------------
+ * Polls a snake's input for the direction to move in this tick.
+ *   BUTTONS: the last arrow key pressed, from the input queue.
+ *   ACTION_BUTTONS: A turns left and B turns right, relative to the snake.
+ *   AI: steers towards the snake's own food, see steer_ai().
+ *
+ */
+direction_t next_direction(player_t* player, uint8_t index) {
+	int8_t turn;
+	
+	switch (player->input) {
+		case ACTION_BUTTONS:
+			turn = action_turn;
+			action_turn = 0;
+			return turn_direction(player->dir, turn);
+		case AI:
+			return steer_ai(player, food[index]);
+		case BUTTONS:
 		default:
-			update = current;
+			claim_input();
+			return update_direction(player->dir);
 	}
+}
+
+
+/*
+ * Function:  turn_direction
+ * --------------------------
+ * Turns a direction a quarter turn left (TURN_LEFT) or right (TURN_RIGHT).
+ *
+ */
+direction_t turn_direction(direction_t current, int8_t turn) {
+	static const direction_t left_of[] = {LEFT, RIGHT, DOWN, UP};
+	static const direction_t right_of[] = {RIGHT, LEFT, UP, DOWN};
+	
+	if (current == NONE) return current;
+	if (turn == TURN_LEFT) return left_of[current];
+	if (turn == TURN_RIGHT) return right_of[current];
+	return current;
+}
+
+
+/*
+ * Function:  steer_ai
+ * --------------------
+ * A greedy opponent. Of the three directions that do not reverse the snake, picks
+ * the one that does not crash and brings the head closest to the target, going 
+ * straight on when there is a tie. Distances wrap around the edges of the world.
+ *
+ *  player: The snake to steer.
+ *  target: The food it is after.
+ *
+ */
+direction_t steer_ai(player_t* player, point_t target) {
+	static const int8_t turns[] = {TURN_NONE, TURN_LEFT, TURN_RIGHT};
+	point_t head = get_head_position(&player->snake);
+	direction_t dir, best = player->dir;
+	uint8_t i, distance, closest = 0xFF;
+	
+	for (i = 0; i < 3; i++) {
+		dir = turn_direction(player->dir, turns[i]);
+		point_t next = next_pos(head, dir);
+		if (is_wall(next)) continue;
+		distance = wrap_distance(next.x, target.x, WORLD_COLUMNS) + 
+				   wrap_distance(next.y, target.y, WORLD_ROWS);
+		if (distance < closest) {
+			closest = distance;
+			best = dir;
+		}
+	}
+	return best;
+}
+
+uint8_t wrap_distance(int8_t a, int8_t b, uint8_t size) {
+	uint8_t d = (a > b) ? a - b : b - a;
+#if RULE_EDGES == EDGES_SOLID
+	return d; // No way round the edge
+#else
+	return (d > size - d) ? size - d : d;
+#endif
+}
+
+/*
+ * Function:  update_direction
+ * ----------------------------
+ * Turns to the last arrow key pressed since the last tick, unless it would 
+ * reverse the snake. Every press queued is taken; A and B are acted on by the
+ * INT1 ISR as they are pressed, so they are passed over here.
+ *
+ */
+direction_t update_direction(direction_t current) {
+	direction_t update = NONE;
+	button_t button;
+	
+	while ((button = pop_input()) != BUTTON_NONE) {
+		if (button <= BUTTON_RIGHT) update = (direction_t)button;
+	}
+	if (update == NONE || update == OPPOSITE(current)) return current;
 	return update;
 }
 
@@ -110,14 +560,36 @@ direction_t update_direction(direction_t current) {
  * message should be displayed on the screen for the user too.
  *
  */
-void end_snake_game(snake_t* snake) {
+void end_snake_game(void) {
+	uint8_t i;
+	
+	record_event(REC_END, FAULT_NONE, REC_GAME_OVER);
+	flush_recorder(REC_GAME_OVER);
 	LCD_clear();
-	clear_snake(snake);
+	for (i = 0; i < player_count; i++) {
+		if (!is_empty_snake(&players[i].snake)) clear_snake(&players[i].snake);
+	}
+	free_spare_nodes();
 	clear_walls();
+	action_steering = FALSE;
+	action_rewind = FALSE;
 	return;
 }
 
+/*
+ * Function:  update_buffer
+ * -------------------------
+ * Stores an object in the world, both in FRAM and, if the point is in view, 
+ * in the walls buffer that caches it.
+ *
+ */
 void update_buffer(point_t pt, obj_t object) {
+	write_world_cell(pt, object);
+	if (in_view(pt)) cache_cell(pt, object);
+	return;
+}
+
+void cache_cell(point_t pt, obj_t object) {
 	address_t location = pt2bufferaddress(pt);
 	byte mask = _BV(location.bit) | _BV(location.bit+1);
 	byte msg = (object&0b11) << location.bit;
@@ -125,46 +597,106 @@ void update_buffer(point_t pt, obj_t object) {
 	return;
 }
 
+
+/*
+ * Function:  pt2bufferaddress
+ * ----------------------------
+ * Finds the slot of the walls buffer that caches a point of the world. The 
+ * world wraps around the buffer, see world.c.
+ *
+ */
 address_t pt2bufferaddress(point_t pt) {
 	address_t location;
+	uint8_t row = pt.y % MAX_SNAKE_ROW;
 	location.column = pt.x % MAX_SNAKE_COLUMN;
-	location.page = (pt.y / SNAKE_ROWS_PER_PAGE) % MAX_SNAKE_PAGE;
-	location.bit = SNAKE_ROW_BIT_SIZE*(pt.y % SNAKE_ROWS_PER_PAGE);
+	location.page = row / SNAKE_ROWS_PER_PAGE;
+	location.bit = SNAKE_ROW_BIT_SIZE*(row % SNAKE_ROWS_PER_PAGE);
 	return location;
 }
 
 
+/*
+ * Function:  enter_cell
+ * ----------------------
+ * Moves a snake's head into a cell of the world. The cell's slot is worked out
+ * once, and its object read once, from the walls buffer if it is in view or 
+ * else from FRAM. Unless the cell is solid, the head is then stored over it in
+ * the same read-modify-write, and drawn. SPECIAL is never left on the board 
+ * during a game, so it is treated as solid.
+ *
+ *  pt: The new head.
+ *
+ *  returns: What was in the cell, for the caller to act on: EMPTY, FOOD to be 
+ *           eaten, or a WALL or SPECIAL that the snake crashed into.
+ *
+ */
+obj_t enter_cell(point_t pt) {
+	if (OFF_WORLD(pt)) return WALL;
+	
+	address_t loc = pt2bufferaddress(pt);
+	byte mask = 0b11 << loc.bit;
+	byte* cached = &walls[loc.column][loc.page];
+	uint16_t address = world_address(pt);
+	bool visible = in_view(pt);
+	byte stored = 0;
+	obj_t object;
+	
+	if (visible) {
+		object = GET(0b11, *cached >> loc.bit);
+	} else {
+		stored = fram_read_byte(address);
+		object = GET(0b11, stored >> loc.bit);
+	}
+	if (object == WALL || object == SPECIAL) return object;
+	
+	if (visible) {
+		SET(*cached, mask, WALL << loc.bit);
+		stored = fram_read_byte(address);
+	}
+	SET(stored, mask, WALL << loc.bit);
+	fram_write_byte(address, stored);
+	if (visible) write_display(pt);
+	return object;
+}
+
+
 /*
  * Function:  is_wall
  * -------------------
- * Determines if the given point is a wall or free space.
+ * Determines if the given point is a wall or free space. With solid edges, 
+ * anywhere off the world is a wall too.
  *
  *  returns: True, if the given point is a wall.
  *
  */
 byte is_wall(point_t pt) {
-	
-	// TODO: Check if the wall is actually a food?
-	// TODO: Return false if out of bounds
+	return OFF_WORLD(pt) || get_object(pt) == WALL;
+}
+
+
+/*
+ * Function:  get_object
+ * ----------------------
+ * Reads the object stored at the given point, from the walls buffer if it is 
+ * in view, or else from FRAM.
+ *
+ */
+obj_t get_object(point_t pt) {
 	address_t loc = pt2bufferaddress(pt);
-	byte object = GET(0x11, walls[loc.column][loc.page] >> loc.bit);
-	return object == WALL;
+	if (!in_view(pt)) return read_world_cell(pt);
+	return GET(0b11, walls[loc.column][loc.page] >> loc.bit);
 }
 
 
 /*
  * Function:  clear_walls
  * -----------------------
- * Removes all walls from memory.
+ * Removes all walls from memory, and from the world in FRAM.
  *
  */
 void clear_walls(void) {
-	byte i, j;
-	for (i = 0; i < MAX_SNAKE_COLUMN; i++) {
-		for (j = 0; j < MAX_SNAKE_PAGE; j++) {
-			walls[i][j] = OFF;
-		}
-	}
+	fill_board(EMPTY);
+	clear_world();
 	// TODO: Redraw the food
 }
 
@@ -187,60 +719,64 @@ bool equal_pts(point_t pt1, point_t pt2) {
 /*
  * Function:  generate_food
  * ------------------------
- * The food should not be generated anywhere. It must not be placed where the snake 
- * is currently residing. This function iterates over the random location generator
- * until a free space is found.
+ * The food should not be generated anywhere. It must not be placed where a snake 
+ * is currently residing, or on other food. The free cells in view are counted,
+ * and one of them picked at random, so a place is found in a single pass over 
+ * the walls buffer however full the board gets. Food is only placed in view, 
+ * so that the player can see it.
  *
- *  returns: The location of the generated food.
+ * The cell is picked with a generator of its own, see seed_food().
+ *
+ *  returns: The location of the generated food, or NO_CELL once there are no
+ *           free cells left in view.
  *
  */
 point_t generate_food(void) {
+	uint16_t free_cells = count_cells(EMPTY);
 	point_t food;
 
-	do { food = generate_random_location(); } 
-	while(is_wall(food));
+	if (free_cells == 0) return NO_CELL;
+	food = cached_point(find_cell(EMPTY, next_random(&food_random) % free_cells));
 
 	draw_food(food);
+	record_food(food);
 	return food;
 }
 
 
 /*
- * Function:  generate_random_location
- * ------------------------------------
- * Randomly generates a location for the food.
+ * Function:  eat_food
+ * --------------------
+ * Grows a snake whose head has been stored over a food, and replaces the food.
+ * The head is already on the board, so the new food can never land under it.
  *
- *  returns: The location.
+ *  snake: The linked-list representing the snake.
+ *  head: Where the food was.
  *
  */
-point_t generate_random_location(void) {
-	point_t pt;
-	pt.x = rand() % MAX_SNAKE_COLUMN;
-	pt.y = rand() % MAX_SNAKE_ROW;
-	return pt;
+void eat_food(snake_t* snake, point_t head) {
+	uint8_t i;
+	
+	for (i = 0; i < player_count; i++) {
+		if (equal_pts(head, food[i])) {
+			increase_length(snake);
+			food[i] = generate_food();
+			return;
+		}
+	}
 }
 
 
 /*
- * Function:  check_food_collision
- * --------------------------------
- * Checks if the snake has run into the food. If the snake has, then 
- * a new food is generated and the snake's length is increased. Otherwise,
- * the same food is returned.
- *
- *  snake: The linked-list representing the snake.
- *	food: The location of the food.
- *
- *  returns: The location of the food.
+ * Function:  seed_food
+ * ---------------------
+ * Seeds the generator that places the food. It is kept apart from rand(), so
+ * that the food of a game depends on this seed alone, and a game can be played
+ * again exactly, e.g. by the host's lockstep engine, see host/lockstep.c. A 
+ * seed of zero, which the generator could never leave, is taken as one.
  *
  */
-point_t check_food_collision(snake_t* snake, point_t food) {
-	
-	if (equal_pts(get_head_position(snake), food)) {
-		increase_length(snake);
-		clear(food);  // Need this? Snake will eat over the food
-		return generate_food();
-	} else {
-		return food;
-	}
+void seed_food(uint16_t seed) {
+	food_random = (seed == 0) ? 1 : seed;
+	return;
 }
@@ -0,0 +1,176 @@
+/*************************************************************************
+Title: Flight Recorder
+Author: Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Always-on log of what the game did: turns, food spawns, length
+	changes, crashes and ticks that ran over. Recording an event stores
+	three bytes in a small ring in RAM, which takes a few dozen cycles and
+	no SPI, so it can be left in every build.
+
+	There is no room in 1 KB of SRAM for a few hundred events, so the RAM
+	ring only holds the last RECORDER_RAM_EVENTS. Between ticks, once it
+	is half full, it is spilled in one burst to a bigger ring in the FRAM
+	after the world, which holds the last RECORDER_EVENTS (146). When a
+	game ends, or on a fault such as the heap running out, whatever is
+	still in RAM is flushed as well, along with why. The FRAM keeps the
+	log across power cycles, until tools/recorder_decode.py reads it out.
+
+	FRAM, from RECORDER_BASE:
+
+		header			8 bytes, see recorder_header_t
+		events			RECORDER_EVENTS of 3 bytes: tick, kind and data,
+						value, see event_t
+
+	The tick of an event is only its low byte, so a REC_TICKS event is
+	recorded every 256 ticks with the high byte, for the decoder to count
+	the ticks with.
+
+*************************************************************************/
+
+#include "console.h"
+#include "snake.h"
+#include "world.h"
+#include "fram.h"
+#include "recorder.h"
+
+static event_t ring[RECORDER_RAM_EVENTS];
+static uint8_t ring_head = 0, pending = 0;
+static uint16_t tick = 0;
+static recorder_header_t header;
+
+
+/*
+ * Function:  init_recorder
+ * -------------------------
+ * Carries on from the log already in FRAM, or formats it if there is none.
+ * The header is left as it is until the next spill, so the state of the 
+ * last game can still be read after a reset. The recorder's ticks start 
+ * again from 0, which is logged for the decoder. FRAM is set up first.
+ *
+ */
+void init_recorder(void) {
+	fram_read(RECORDER_BASE, (byte*)&header, RECORDER_HEADER_BYTES);
+	if (header.magic[0] != RECORDER_MAGIC_0 || header.magic[1] != RECORDER_MAGIC_1 ||
+		header.next >= RECORDER_EVENTS) {
+		header = (recorder_header_t){{RECORDER_MAGIC_0, RECORDER_MAGIC_1}, REC_RUNNING, 0, 0, 0};
+		fram_write(RECORDER_BASE, (byte*)&header, RECORDER_HEADER_BYTES);
+	}
+	record_event(REC_TICKS, 0, 0);
+	return;
+}
+
+
+/*
+ * Function:  record_event
+ * ------------------------
+ * Adds an event to the RAM ring. Once the ring is full, each event overwrites
+ * the oldest one not yet spilled, which is counted as lost.
+ *
+ *  kind: What happened.
+ *  data: 5 bits, e.g. the player.
+ *  value: A byte, e.g. the new direction.
+ *
+ */
+void record_event(event_kind_t kind, uint8_t data, uint8_t value) {
+	event_t* event = &ring[ring_head];
+
+	event->tick = tick;
+	event->kind = EVENT_KIND(kind, data);
+	event->value = value;
+	ring_head = (ring_head + 1) & (RECORDER_RAM_EVENTS - 1);
+	if (pending < RECORDER_RAM_EVENTS) pending++;
+	else header.lost++;
+	return;
+}
+
+
+/*
+ * Function:  record_food
+ * -----------------------
+ * Records where food was put. A point of the world needs 13 bits, which are
+ * split between the 5 bits of data and the value.
+ *
+ */
+void record_food(point_t pt) {
+	record_event(REC_FOOD, pt.x >> 2, (pt.x << 6) | pt.y);
+	return;
+}
+
+
+/*
+ * Function:  record_tick
+ * -----------------------
+ * Moves the recorder on to the next tick. Called between ticks, where it is
+ * safe to spill the RAM ring to FRAM.
+ *
+ */
+void record_tick(void) {
+	tick++;
+	if ((tick & 0xFF) == 0) record_event(REC_TICKS, 0, tick >> 8);
+	if (pending >= RECORDER_SPILL) {
+		header.state = REC_RUNNING;
+		spill_recorder();
+	}
+	return;
+}
+
+
+/*
+ * Function:  spill_recorder
+ * --------------------------
+ * Copies every pending event from the RAM ring to the FRAM ring, and then
+ * updates the header, so that a power cut part-way through never leaves the
+ * header pointing past what was written. Both rings wrap, so the events are
+ * written in as few runs as they allow, at most four.
+ *
+ */
+void spill_recorder(void) {
+	uint8_t tail = (ring_head - pending) & (RECORDER_RAM_EVENTS - 1);
+	uint8_t run;
+
+	while (pending > 0) {
+		run = pending;
+		if (run > RECORDER_RAM_EVENTS - tail) run = RECORDER_RAM_EVENTS - tail;
+		if (run > RECORDER_EVENTS - header.next) run = RECORDER_EVENTS - header.next;
+		fram_write(RECORDER_BASE + RECORDER_HEADER_BYTES + header.next*RECORDER_EVENT_BYTES,
+			(byte*)&ring[tail], run*RECORDER_EVENT_BYTES);
+
+		tail = (tail + run) & (RECORDER_RAM_EVENTS - 1);
+		header.next += run;
+		if (header.next == RECORDER_EVENTS) header.next = 0;
+		header.total = (header.total < 0xFFFF - run) ? header.total + run : 0xFFFF;
+		pending -= run;
+	}
+	fram_write(RECORDER_BASE, (byte*)&header, RECORDER_HEADER_BYTES);
+	return;
+}
+
+
+/*
+ * Function:  flush_recorder
+ * --------------------------
+ * Spills everything still in RAM, and records why, e.g. at game over.
+ *
+ */
+void flush_recorder(recorder_state_t state) {
+	header.state = state;
+	spill_recorder();
+	return;
+}
+
+
+/*
+ * Function:  record_fault
+ * ------------------------
+ * Records a fault and flushes the log, before the caller gives up. Must not
+ * be called part-way through an SPI transfer.
+ *
+ */
+void record_fault(fault_t fault) {
+	record_event(REC_END, fault, REC_FAULT);
+	flush_recorder(REC_FAULT);
+	return;
+}
@@ -0,0 +1,78 @@
+/*************************************************************************
+Title: Rewind
+Author: Patrick Lewien (694555)
+Software: AVR-GCC
+Hardware: ATMEGA16 @ 8Mhz
+
+DESCRIPTION:
+	Keeps the last REWIND_DELTAS ticks of the solo snake game, so it can
+	be played backwards while the B-button is held. Rather than snapshots
+	of the walls buffer and the node list, each tick is kept as a delta
+	of 4 bits, from which the tick can be undone exactly:
+
+	  - the head added is not stored at all. If the head node has a
+	    length of 1, the tick pushed it, or else the tick extended it.
+	  - the tail cell removed, if any, is next to the tail tip, against
+	    the tail's direction. Only the direction of the node it was
+	    removed from is stored: if it matches the tail's, the cell was
+	    taken off the tail node, or else the whole node was popped.
+	    Neighbouring nodes never share a direction.
+	  - the food eaten, if any, was under the new head, and the snake
+	    grew by LENGTH_DELTA. The food it was replaced by is the current
+	    food, so a single bit is enough.
+
+	Two deltas are packed into every byte, so a second of history costs
+	2.5 bytes at 5 ticks a second, and REWIND_BYTES hold 12.8s.
+
+*************************************************************************/
+
+#include "console.h"
+#include "rewind.h"
+
+static byte deltas[REWIND_BYTES];
+static uint8_t newest = 0;	// Where the next delta goes
+static uint8_t stored = 0;
+
+
+void clear_deltas(void) {
+	stored = 0;
+	return;
+}
+
+
+/*
+ * Function:  push_delta
+ * ----------------------
+ * Keeps the delta of the tick just played, over the oldest one once the
+ * history is full.
+ *
+ */
+void push_delta(byte delta) {
+	byte shift = (newest & 1) * 4;
+	byte mask = 0x0F << shift;
+
+	SET(deltas[newest >> 1], mask, delta << shift);
+	newest = (newest + 1) % REWIND_DELTAS;
+	if (stored < REWIND_DELTAS) stored++;
+	return;
+}
+
+
+/*
+ * Function:  pop_delta
+ * ---------------------
+ * Takes back the delta of the last tick played.
+ *
+ *  returns: The delta, or NO_DELTA once the history has run out.
+ *
+ */
+byte pop_delta(void) {
+	if (stored == 0) return NO_DELTA;
+	stored--;
+	newest = (newest + REWIND_DELTAS - 1) % REWIND_DELTAS;
+	return (deltas[newest >> 1] >> ((newest & 1) * 4)) & 0x0F;
+}
+
+uint8_t count_deltas(void) {
+	return stored;
+}
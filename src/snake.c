@@ -14,6 +14,10 @@ DESCRIPTION:
 
 #include "console.h"
 #include "snake.h"
+#include "recorder.h"
+
+#if RULE_BODY == BODY_SEGMENTS
+static node_t* spare_nodes = NULL;	// Nodes of finished snakes, kept for the next game
 
 	
 /*
@@ -21,30 +25,17 @@ DESCRIPTION:
  * -----------------------
  * Creates a snake to be displayed on the screen. Acts as a linked list.
  *
+ *  snake: The snake to initialise, allocated by the caller.
  *  starting_pos: The initial location of the snake.
  *
- *  returns: The initialised snake.
- *
  */
-snake_t* create_snake(point_t starting_pos, direction_t dir) {
-	snake_t* snake = malloc(sizeof(snake_t));
+void create_snake(snake_t* snake, point_t starting_pos, direction_t dir) {
 	snake->length = 1;
 	snake->max_length = START_LENGTH;
+	snake->head = NULL;
+	snake->tail = NULL;
 	push_head(snake, starting_pos, dir);
 	draw(starting_pos);
-	return snake;
-}
-
-/*
- * Function:  increase_length
- * ---------------------------
- * Adds to the snake's total possible length by a specified delta.
- *
- *  snake: The linked-list representing the snake.
- *
- */
-void increase_length(snake_t* snake) {
-	snake->max_length += LENGTH_DELTA;
 	return;
 }
 
@@ -66,7 +57,7 @@ void increase_length(snake_t* snake) {
  point_t add_to_head(snake_t* snake, direction_t dir) {
 	
 	//Move snake head in currently-polled direction
-	point_t move = move_pos(get_head_position(snake), dir, 1);
+	point_t move = next_pos(get_head_position(snake), dir);
 	
 	// Check whether snake is moving in the same direction
 	if (dir == snake->head->dir) {
@@ -93,8 +84,7 @@ void increase_length(snake_t* snake) {
  *
  */
 void push_head(snake_t* snake, point_t pt, direction_t dir) {
-	node_t *n = malloc(sizeof(node_t));
-	assert(n != NULL);
+	node_t *n = alloc_node();
 	n->pos = pt;
 	n->length = 1;
 	n->dir = dir;
@@ -109,6 +99,69 @@ void push_head(snake_t* snake, point_t pt, direction_t dir) {
 }
 
 
+/*
+ * Function:  remove_from_head
+ * ----------------------------
+ * Takes back the last add_to_head(), when the game is rewound. A head node of
+ * length 1 was pushed by it, and is freed. The list only links towards the 
+ * head, so the node before it is found by walking up from the tail.
+ *
+ *  snake: The linked list, of more than one cell.
+ *
+ *  returns: The position the head was at.
+ *
+ */
+point_t remove_from_head(snake_t* snake) {
+	node_t *head = snake->head, *node;
+	point_t pos = head->pos;
+	
+	(snake->length)--;
+	if (head->length > 1) {
+		(head->length)--;
+		head->pos = move_pos(pos, head->dir, -1);
+	} else {
+		for (node = snake->tail; node->ptr != head; node = node->ptr);
+		node->ptr = NULL;
+		snake->head = node;
+		heap_free(head);
+	}
+	return pos;
+}
+
+
+/*
+ * Function:  add_to_tail
+ * -----------------------
+ * Takes back the last remove_from_tail(), when the game is rewound. The cell
+ * removed is always the one behind the tail tip. If it came from a node in
+ * another direction, that node was popped, and is pushed back.
+ *
+ *  snake: The linked list.
+ *  dir: The direction of the node the cell was removed from.
+ *
+ *  returns: The position of the cell put back.
+ *
+ */
+point_t add_to_tail(snake_t* snake, direction_t dir) {
+	node_t *n, *tail = snake->tail;
+	point_t pos = move_pos(tail->pos, tail->dir, -(tail->length));
+	
+	(snake->length)++;
+	if (dir == tail->dir) {
+		(tail->length)++;
+		return pos;
+	}
+	
+	n = alloc_node();
+	n->pos = pos;
+	n->length = 1;
+	n->dir = dir;
+	n->ptr = tail;
+	snake->tail = n;
+	return pos;
+}
+
+
 /*
  * Function:  get_head_position
  * --------------------
@@ -170,14 +223,14 @@ point_t pop_tail(snake_t* snake) {
 	
     // if there is only one item in the list, remove it
     if (temp == NULL) {
-        free(snake->tail);
+        heap_free(snake->tail);
 		snake->head = NULL;
 		snake->tail = NULL;
     } 
 	
 	// otherwise, remove tail and make it the next one
 	else {
-		free(snake->tail);
+		heap_free(snake->tail);
 		snake->tail = temp;
 	}
 	
@@ -199,7 +252,7 @@ point_t pop_tail_tip(node_t* tail) {
 
 	point_t pos = tail->pos;
 	direction_t dir = tail->dir;
-	byte dist = 1-(tail->length);  // negative, since dir is opposite.
+	int16_t dist = 1-(tail->length);  // negative, since dir is opposite.
 	
 	(tail->length)--;
 	return move_pos(pos, dir, dist);
@@ -208,7 +261,7 @@ point_t pop_tail_tip(node_t* tail) {
 /*
  * Function:  clear_snake 
  * ------------------------
- * Clears all memory associated with the snake.
+ * Frees all the segments of the snake. The snake itself is owned by the caller.
  *
  *  snake: The linked list.
  *
@@ -219,7 +272,459 @@ void clear_snake(snake_t* snake) {
 	while (snake->tail != NULL) {
 		pop_tail(snake);
 	}
-	free(snake);
+}
+
+/*
+ * Function:  erase_snake 
+ * ------------------------
+ * Clears every cell of the snake off the board, walking each segment back from
+ * its front cell. Only the cells the snake covers are touched.
+ *
+ *  snake: The linked list, which is left as it is.
+ *  head_drawn: False if the snake crashed, since its last head was never drawn
+ *              and the cell still holds whatever it crashed into.
+ *
+ */
+void erase_snake(snake_t* snake, bool head_drawn) {
+	node_t* node;
+	uint8_t i;
+	
+	for (node = snake->tail; node != NULL; node = node->ptr) {
+		i = (node == snake->head && !head_drawn) ? 1 : 0;
+		for (; i < node->length; i++) {
+			clear(move_pos(node->pos, node->dir, -i));
+		}
+	}
+	return;
+}
+
+
+/*
+ * Function:  recycle_snake 
+ * --------------------------
+ * Keeps all the segments of the snake for the next game to reuse, rather than
+ * freeing them one by one. The list links from the tail to the head, so it is
+ * spliced whole onto the spare nodes, whatever its length.
+ *
+ *  snake: The linked list, which is left empty.
+ *
+ */
+void recycle_snake(snake_t* snake) {
+	if (snake->head == NULL) return;
+	snake->head->ptr = spare_nodes;
+	spare_nodes = snake->tail;
+	snake->head = NULL;
+	snake->tail = NULL;
+	return;
+}
+
+
+/*
+ * Function:  alloc_node 
+ * ----------------------
+ * Takes a spare node left by recycle_snake(), or else allocates a new one.
+ *
+ *  returns: The node, uninitialised.
+ *
+ */
+node_t* alloc_node(void) {
+	node_t* n = spare_nodes;
+	
+	if (n != NULL) {
+		spare_nodes = n->ptr;
+		return n;
+	}
+	n = heap_alloc(sizeof(node_t));
+	if (n == NULL) record_fault(FAULT_HEAP); // Keep the log of how it got here
+	assert(n != NULL);
+	return n;
+}
+
+
+/*
+ * Function:  free_spare_nodes 
+ * ----------------------------
+ * Hands the spare nodes back to the heap, once no more snakes are to be played.
+ *
+ */
+void free_spare_nodes(void) {
+	node_t* n;
+	
+	while (spare_nodes != NULL) {
+		n = spare_nodes;
+		spare_nodes = n->ptr;
+		heap_free(n);
+	}
+	return;
+}
+
+
+/*
+ * Function:  count_segments 
+ * --------------------------
+ *  returns: The number of nodes in the linked list.
+ *
+ */
+uint8_t count_segments(snake_t* snake) {
+	uint8_t count = 0;
+	node_t* node;
+	for (node = snake->tail; node != NULL; node = node->ptr) {
+		count++;
+	}
+	return count;
+}
+
+/*
+ * Function:  get_head_direction
+ * ------------------------------
+ *  returns: The direction the head last moved in.
+ *
+ */
+direction_t get_head_direction(snake_t* snake) {
+	return snake->head->dir;
+}
+
+/*
+ * Function:  get_tail_direction
+ * ------------------------------
+ *  returns: The direction the tail cell was entered by, as add_to_tail() 
+ *           wants it back.
+ *
+ */
+direction_t get_tail_direction(snake_t* snake) {
+	return snake->tail->dir;
+}
+
+bool is_empty_snake(snake_t* snake) {
+	return snake->head == NULL;
+}
+
+
+/*
+ * Function:  covers_point
+ * ------------------------
+ * Finds whether a cell is part of the snake, from the body alone rather than
+ * the board. Each segment is checked whole, as a line back from its front.
+ *
+ */
+bool covers_point(snake_t* snake, point_t pt) {
+	node_t* node;
+	int16_t behind;
+	
+	for (node = snake->tail; node != NULL; node = node->ptr) {
+		if (node->dir == UP || node->dir == DOWN) {
+			if (pt.x != node->pos.x) continue;
+			behind = (node->dir == UP) ? pt.y - node->pos.y : node->pos.y - pt.y;
+			if (behind < 0) behind += WORLD_ROWS;
+		} else {
+			if (pt.y != node->pos.y) continue;
+			behind = (node->dir == LEFT) ? pt.x - node->pos.x : node->pos.x - pt.x;
+			if (behind < 0) behind += WORLD_COLUMNS;
+		}
+		if (behind < node->length) return TRUE;
+	}
+	return FALSE;
+}
+
+
+/*
+ * Function:  body_bytes
+ * ----------------------
+ *  returns: The RAM held by the snake: itself, and each of its nodes with the 
+ *           allocator's header.
+ *
+ */
+uint16_t body_bytes(snake_t* snake) {
+	uint16_t bytes = sizeof(snake_t);
+	node_t* node;
+	
+	for (node = snake->tail; node != NULL; node = node->ptr) {
+		bytes += sizeof(node_t) + sizeof(size_t);
+	}
+	return bytes;
+}
+
+#else
+
+/*
+ * The body is kept as its tail cell and the moves from there to the head, 
+ * each the direction_t it was made in, packed four to a byte in a ring. The
+ * head is moved on by adding a move at one end of the ring, and the tail by
+ * taking one off the other, so nothing is allocated, and a snake always 
+ * takes the same RAM. The ring holds BODY_CELLS moves, one more than the 
+ * longest snake has.
+ */
+
+static direction_t get_move(snake_t* snake, uint16_t index) {
+	return (snake->moves[index/BODY_MOVES_PER_BYTE] >> (2*(index % BODY_MOVES_PER_BYTE))) & 0b11;
+}
+
+static void set_move(snake_t* snake, uint16_t index, direction_t dir) {
+	byte shift = 2*(index % BODY_MOVES_PER_BYTE);
+	byte* moves = &snake->moves[index/BODY_MOVES_PER_BYTE];
+	
+	*moves = (*moves & ~(0b11 << shift)) | (dir << shift);
+	return;
+}
+
+
+/*
+ * Function:  move_index
+ * ----------------------
+ *  returns: The index in the ring of a move, counting from the oldest.
+ *
+ */
+static uint16_t move_index(snake_t* snake, uint16_t nth) {
+	uint16_t index = snake->oldest + nth;
+	return (index >= BODY_CELLS) ? index - BODY_CELLS : index;
+}
+
+
+/*
+ * Function:  create_snake
+ * -----------------------
+ * Creates a snake to be displayed on the screen, of a single cell, and so 
+ * no moves.
+ *
+ *  snake: The snake to initialise, allocated by the caller.
+ *  starting_pos: The initial location of the snake.
+ *
+ */
+void create_snake(snake_t* snake, point_t starting_pos, direction_t dir) {
+	snake->length = 1;
+	snake->max_length = START_LENGTH;
+	snake->grown_length = START_LENGTH;
+	snake->head = starting_pos;
+	snake->tail = starting_pos;
+	snake->tail_dir = dir;
+	snake->oldest = 0;
+	draw(starting_pos);
+	return;
+}
+
+
+/*
+ * Function:  add_to_head
+ * ----------------------
+ * Shifts the snake's head forward by one, adding the move to the ring.
+ *
+ *  returns: The new position of the head.
+ *
+ */
+point_t add_to_head(snake_t* snake, direction_t dir) {
+	snake->head = next_pos(snake->head, dir);
+	set_move(snake, move_index(snake, snake->length - 1), dir);
+	(snake->length)++;
+	return snake->head;
+}
+
+
+/*
+ * Function:  remove_from_head
+ * ----------------------------
+ * Takes back the last add_to_head(), when the game is rewound.
+ *
+ *  snake: The snake, of more than one cell.
+ *
+ *  returns: The position the head was at.
+ *
+ */
+point_t remove_from_head(snake_t* snake) {
+	point_t pos = snake->head;
+	
+	snake->head = next_pos(pos, OPPOSITE(get_head_direction(snake)));
+	(snake->length)--;
+	return pos;
+}
+
+
+/*
+ * Function:  add_to_tail
+ * -----------------------
+ * Takes back the last remove_from_tail(), when the game is rewound. The move
+ * from the cell put back to the tail is the one the tail was entered by.
+ *
+ *  dir: The direction the cell put back was entered by, see get_tail_direction().
+ *
+ *  returns: The position of the cell put back.
+ *
+ */
+point_t add_to_tail(snake_t* snake, direction_t dir) {
+	snake->oldest = (snake->oldest == 0) ? BODY_CELLS - 1 : snake->oldest - 1;
+	set_move(snake, snake->oldest, snake->tail_dir);
+	snake->tail = next_pos(snake->tail, OPPOSITE(snake->tail_dir));
+	snake->tail_dir = dir;
+	(snake->length)++;
+	return snake->tail;
+}
+
+point_t get_head_position(snake_t* snake) {
+	return snake->head;
+}
+
+direction_t get_head_direction(snake_t* snake) {
+	if (snake->length < 2) return snake->tail_dir;
+	return get_move(snake, move_index(snake, snake->length - 2));
+}
+
+direction_t get_tail_direction(snake_t* snake) {
+	return snake->tail_dir;
+}
+
+bool is_empty_snake(snake_t* snake) {
+	return snake->length == 0;
+}
+
+
+/*
+ * Function:  remove_from_tail 
+ * ----------------------------
+ * Takes the tail cell off the snake, and moves the tail on by the oldest move.
+ *
+ *  returns: The position of the cell taken off.
+ *
+ */
+point_t remove_from_tail(snake_t* snake) {
+	point_t pos = snake->tail;
+	
+	(snake->length)--;
+	if (snake->length == 0) return pos;
+	snake->tail_dir = get_move(snake, snake->oldest);
+	snake->tail = next_pos(pos, snake->tail_dir);
+	snake->oldest = move_index(snake, 1);
+	return pos;
+}
+
+
+/*
+ * Function:  clear_snake 
+ * ------------------------
+ * Empties the snake. There is nothing to free.
+ *
+ */
+void clear_snake(snake_t* snake) {
+	snake->length = 0;
+	return;
+}
+
+void recycle_snake(snake_t* snake) {
+	clear_snake(snake);
+	return;
+}
+
+void free_spare_nodes(void) {
+	return;
+}
+
+
+/*
+ * Function:  erase_snake 
+ * ------------------------
+ * Clears every cell of the snake off the board, walking the moves from the
+ * tail to the head.
+ *
+ *  head_drawn: False if the snake crashed, since its last head was never drawn
+ *              and the cell still holds whatever it crashed into.
+ *
+ */
+void erase_snake(snake_t* snake, bool head_drawn) {
+	uint16_t cells = snake->length - (head_drawn ? 0 : 1), i, index = snake->oldest;
+	point_t pos = snake->tail;
+	
+	if (is_empty_snake(snake)) return;
+	for (i = 0; i < cells; i++) {
+		clear(pos);
+		pos = next_pos(pos, get_move(snake, index));
+		index = (index == BODY_CELLS - 1) ? 0 : index + 1;
+	}
+	return;
+}
+
+
+/*
+ * Function:  count_segments 
+ * --------------------------
+ *  returns: The number of straight runs of the body, as the list would have
+ *           nodes, up to UINT8_MAX.
+ *
+ */
+uint8_t count_segments(snake_t* snake) {
+	direction_t last = snake->tail_dir, dir;
+	uint16_t i, index = snake->oldest, count = 1;
+	
+	if (is_empty_snake(snake)) return 0;
+	for (i = 1; i < snake->length && count < UINT8_MAX; i++) {
+		dir = get_move(snake, index);
+		count += dir != last;
+		last = dir;
+		index = (index == BODY_CELLS - 1) ? 0 : index + 1;
+	}
+	return count;
+}
+
+
+/*
+ * Function:  covers_point
+ * ------------------------
+ * Finds whether a cell is part of the snake, from the body alone rather than
+ * the board, walking it a cell at a time from the tail.
+ *
+ */
+bool covers_point(snake_t* snake, point_t pt) {
+	uint16_t i, index = snake->oldest;
+	point_t pos = snake->tail;
+	
+	for (i = 0; i < snake->length; i++) {
+		if (equal_pts(pos, pt)) return TRUE;
+		pos = next_pos(pos, get_move(snake, index));
+		index = (index == BODY_CELLS - 1) ? 0 : index + 1;
+	}
+	return FALSE;
+}
+
+uint16_t body_bytes(snake_t* snake) {
+	return sizeof(snake_t);
+}
+#endif
+
+
+/*
+ * Function:  increase_length
+ * ---------------------------
+ * Adds to the snake's total possible length, as RULE_GROWTH says. A stream
+ * body stops growing at BODY_CELLS, which is all its ring holds, but keeps
+ * counting the length it would have so decrease_length() can undo each food.
+ *
+ *  snake: The snake.
+ *
+ */
+void increase_length(snake_t* snake) {
+#if RULE_BODY == BODY_STREAM
+	snake->grown_length = GROW(snake->grown_length);
+	snake->max_length = snake->grown_length < BODY_CELLS ? snake->grown_length : BODY_CELLS;
+#else
+	snake->max_length = GROW(snake->max_length);
+#endif
+	return;
+}
+
+/*
+ * Function:  decrease_length
+ * ---------------------------
+ * Takes back the length added by the last increase_length(), for a rewind
+ * past the food that added it.
+ *
+ *  snake: The snake.
+ *
+ */
+void decrease_length(snake_t* snake) {
+#if RULE_BODY == BODY_STREAM
+	snake->grown_length = SHRINK(snake->grown_length);
+	snake->max_length = snake->grown_length < BODY_CELLS ? snake->grown_length : BODY_CELLS;
+#else
+	snake->max_length = SHRINK(snake->max_length);
+#endif
+	return;
 }
 
 /*
@@ -229,27 +734,53 @@ void clear_snake(snake_t* snake) {
  *
  *  pos: The position to be moved.
  *	dir: The direction to be moved in.
- *	dist: How far the point moves in that direction.
+ *	dist: How far the point moves in that direction, or back against it if 
+ *	      negative. Can be up to the length of a node, so it is worked out in
+ *	      16 bits, which a long node near the edge of the world overflows.
  *
  *  returns: A new point, shifted from the input point.
  *
  */
-point_t move_pos(point_t pos, direction_t dir, byte dist) {
+point_t move_pos(point_t pos, direction_t dir, int16_t dist) {
+	int16_t x = pos.x, y = pos.y;
 
 	//Shift the new position in the given direction
 	switch (dir) {
-		case UP: 	pos.y -= dist; break;
-		case DOWN: 	pos.y += dist; break;
-		case LEFT: 	pos.x -= dist; break;
-		case RIGHT:	pos.x += dist; break;
+		case UP: 	y -= dist; break;
+		case DOWN: 	y += dist; break;
+		case LEFT: 	x -= dist; break;
+		case RIGHT:	x += dist; break;
 		case NONE:	break;
 		default: 	break;
 	}
 
-	//Handle reaching the edge of the screen
-	pos.y = bound_check(pos.y, 0, MAX_SNAKE_ROW);
-	pos.x = bound_check(pos.x, 0, MAX_SNAKE_COLUMN);
+	//Handle reaching the edge of the world
+	x %= WORLD_COLUMNS;
+	y %= WORLD_ROWS;
+	pos.x = (x < 0) ? x + WORLD_COLUMNS : x;
+	pos.y = (y < 0) ? y + WORLD_ROWS : y;
+	return pos;
+}
 
+
+/*
+ * Function:  next_pos
+ * --------------------
+ * Moves a position a single cell, as a head does every tick. Unlike move_pos(),
+ * the edge of the world is found with a compare rather than a division, and 
+ * handled as RULE_EDGES says: the position wraps around, or is left off the 
+ * world for the caller to crash on, see OFF_WORLD().
+ *
+ */
+point_t next_pos(point_t pos, direction_t dir) {
+	switch (dir) {
+		case UP: 	pos.y = STEP_BACK(pos.y, WORLD_ROWS); break;
+		case DOWN: 	pos.y = STEP_ON(pos.y, WORLD_ROWS); break;
+		case LEFT: 	pos.x = STEP_BACK(pos.x, WORLD_COLUMNS); break;
+		case RIGHT:	pos.x = STEP_ON(pos.x, WORLD_COLUMNS); break;
+		case NONE:
+		default: 	break;
+	}
 	return pos;
 }
 
@@ -0,0 +1,154 @@
+/*************************************************************************
+Title: Telemetry
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	Streams a frame of metrics for every tick out of the USART, at 
+	TELEMETRY_BAUD, 8N1. A frame is queued in a ring buffer between ticks
+	and sent a byte at a time by the UDRE interrupt, so queueing it costs
+	a few dozen cycles and never waits on the line. A frame that does not
+	fit in the buffer is dropped whole and counted, rather than stalling 
+	the game. At one 20-byte frame per tick, the line is idle for over 
+	95% of a 200ms tick.
+
+	Frame, multi-byte fields little-endian:
+
+		sync (0xA5)
+		tick			2 bytes
+		logic cycles	4 bytes
+		render cycles	4 bytes
+		SPI bytes		2 bytes
+		free RAM		2 bytes
+		snake length	1 byte
+		segments		1 byte
+		latency			2 bytes, in ms, or 0xFFFF without a press
+		checksum		1 byte, the sum of the 18 payload bytes
+
+	Only built with -DTELEMETRY. TXD is PD1, which is also the LCD reset
+	line on the console PCB, so the reset trace must be cut and pulled 
+	high on a board used for telemetry, or every zero bit resets the LCD.
+
+*************************************************************************/
+
+#include "console.h"
+#include "telemetry.h"
+#include "fram.h"
+
+#ifdef TELEMETRY
+
+uint16_t telemetry_dropped = 0;
+static volatile byte tx_buffer[TELEMETRY_BUFFER_SIZE];
+static volatile uint8_t tx_head = 0, tx_tail = 0;
+static byte checksum;
+
+
+/*********************************
+ **	INTERRUPT SERVICE ROUTINES  **
+ *********************************/
+ISR(USART_UDRE_vect) { //Transmit buffer empty: send the next queued byte
+	if (tx_tail == tx_head) {
+		DISABLE_UDRE_INTERRUPT;
+		return;
+	}
+	UDR = tx_buffer[tx_tail];
+	tx_tail = (tx_tail + 1) % TELEMETRY_BUFFER_SIZE;
+}
+
+
+/*
+ * Function:  init_telemetry
+ * --------------------------
+ * Sets the USART up to transmit only. The UDRE interrupt stays off until there
+ * is something to send.
+ *
+ */
+void init_telemetry(void) {
+	SETUP_USART_BAUD(TELEMETRY_UBRR);
+	SETUP_USART_8N1;
+	ENABLE_USART_TX;
+	return;
+}
+
+
+/*
+ * Function:  send_telemetry
+ * --------------------------
+ * Queues a frame for the UDRE interrupt to send.
+ *
+ *  frame: The metrics of the last tick.
+ *
+ *  returns: False, if the frame was dropped because the last one is still 
+ *           being sent.
+ *
+ */
+bool send_telemetry(const telemetry_t* frame) {
+	if (telemetry_space() < TELEMETRY_FRAME_BYTES) {
+		telemetry_dropped++;
+		return FALSE;
+	}
+	
+	queue_telemetry(TELEMETRY_SYNC);
+	checksum = 0;
+	queue_telemetry(frame->tick);
+	queue_telemetry(frame->tick >> 8);
+	queue_telemetry(frame->logic_cycles);
+	queue_telemetry(frame->logic_cycles >> 8);
+	queue_telemetry(frame->logic_cycles >> 16);
+	queue_telemetry(frame->logic_cycles >> 24);
+	queue_telemetry(frame->render_cycles);
+	queue_telemetry(frame->render_cycles >> 8);
+	queue_telemetry(frame->render_cycles >> 16);
+	queue_telemetry(frame->render_cycles >> 24);
+	queue_telemetry(frame->spi_bytes);
+	queue_telemetry(frame->spi_bytes >> 8);
+	queue_telemetry(frame->free_ram);
+	queue_telemetry(frame->free_ram >> 8);
+	queue_telemetry(frame->length);
+	queue_telemetry(frame->segments);
+	queue_telemetry(frame->latency);
+	queue_telemetry(frame->latency >> 8);
+	queue_telemetry(checksum);
+	
+	ENABLE_UDRE_INTERRUPT;
+	return TRUE;
+}
+
+
+/*
+ * Function:  queue_telemetry
+ * ---------------------------
+ * Adds a byte to the ring buffer, and to the running checksum. The caller has 
+ * already made sure there is room. Only the ISR moves the tail, so the buffer
+ * needs no locking.
+ *
+ */
+void queue_telemetry(byte data) {
+	tx_buffer[tx_head] = data;
+	tx_head = (tx_head + 1) % TELEMETRY_BUFFER_SIZE;
+	checksum += data;
+	return;
+}
+
+uint8_t telemetry_space(void) {
+	return (tx_tail - tx_head - 1 + TELEMETRY_BUFFER_SIZE) % TELEMETRY_BUFFER_SIZE;
+}
+
+#endif
+
+
+/*
+ * Function:  spi_bytes_sent
+ * --------------------------
+ * Counts the bytes the game has sent over SPI since power-up: LCD commands and
+ * data from draw.c, and FRAM opcodes, addresses and data. Text from lcdlib is 
+ * not counted.
+ *
+ */
+uint32_t spi_bytes_sent(void) {
+	extern uint32_t lcd_bytes;
+	return lcd_bytes + fram_stats.bytes_read + fram_stats.bytes_written
+		+ (uint32_t)fram_stats.reads*FRAM_HEADER_BYTES 
+		+ (uint32_t)fram_stats.writes*(FRAM_HEADER_BYTES + 1); // and a write-enable
+}
@@ -0,0 +1,310 @@
+/*************************************************************************
+Title: Snake_World
+Author: Patrick Lewien (694555)
+Software: AVR-GCC 
+Hardware: ATMEGA16 @ 8Mhz 
+
+DESCRIPTION:
+	The world is WORLD_SCREENS_X by WORLD_SCREENS_Y screens large, far more
+	than fits in SRAM, so it is kept in FRAM and the walls buffer only 
+	caches the screenful in view. 
+
+	The cache is toroidal: a world cell always lives in the buffer slot 
+	(x % MAX_SNAKE_COLUMN, y % MAX_SNAKE_ROW), and is drawn at that slot 
+	on the screen. When the view scrolls by a column, only the slot of 
+	the column leaving the view is reloaded from FRAM and redrawn, instead
+	of shifting the whole buffer and redrawing the whole screen. The seam
+	between the oldest and newest column moves across the screen, much as
+	the snake used to wrap around its edges.
+
+	In FRAM, each column of the world is stored one screen after another,
+	with every screen of a column laid out just like a column of the walls 
+	buffer, so a screen loads with a plain block read:
+
+		address = ((x*WORLD_SCREENS_Y + screen)*MAX_SNAKE_PAGE + page)
+
+	The cache is write-through. Every change goes to FRAM as well, so a 
+	column leaving the view never needs to be written back. This costs a 
+	read-modify-write of one byte per changed cell, two a tick for a moving
+	snake. Write-back was tried and measured with time_scrolling(): it saves
+	about one FRAM byte written a tick, but a row leaving the view then needs
+	a read-modify-write per changed column of it, as a byte of FRAM holds 
+	four rows and the rows beside it are out of view. The busiest tick went
+	from 29 FRAM transactions to 61, and it is the busiest tick that has to
+	fit in TICK_CYCLES.
+
+*************************************************************************/
+
+#include "console.h"
+#include "snake.h"
+#include "world.h"
+#include "fram.h"
+
+point_t view = {0, 0}; // World position of the top-left of the view
+scroll_stats_t scroll_stats = {0};
+
+
+/*
+ * Function:  reset_view
+ * ----------------------
+ * Moves the view back to the top-left screen of the world, where the walls
+ * buffer and the world line up cell for cell.
+ *
+ */
+void reset_view(void) {
+	view.x = 0;
+	view.y = 0;
+	return;
+}
+
+
+/*
+ * Function:  in_view
+ * -------------------
+ *  returns: True, if the point is cached in the walls buffer and on the screen.
+ *
+ */
+bool in_view(point_t pt) {
+	uint8_t dx = bound_check(pt.x - view.x, 0, WORLD_COLUMNS);
+	uint8_t dy = bound_check(pt.y - view.y, 0, WORLD_ROWS);
+	return dx < MAX_SNAKE_COLUMN && dy < MAX_SNAKE_ROW;
+}
+
+
+/*
+ * Function:  cached_point
+ * ------------------------
+ * The other way round from pt2bufferaddress(): finds the point of the world
+ * held in a slot of the walls buffer.
+ *
+ *  slot: The column and row of the slot.
+ *
+ */
+point_t cached_point(point_t slot) {
+	int8_t dx = bound_check(slot.x - view.x % MAX_SNAKE_COLUMN, 0, MAX_SNAKE_COLUMN);
+	int8_t dy = bound_check(slot.y - view.y % MAX_SNAKE_ROW, 0, MAX_SNAKE_ROW);
+	point_t pt;
+	
+	pt.x = bound_check(view.x + dx, 0, WORLD_COLUMNS);
+	pt.y = bound_check(view.y + dy, 0, WORLD_ROWS);
+	return pt;
+}
+
+
+/*
+ * Function:  follow
+ * ------------------
+ * Scrolls the view until the point is within the slack around its centre.
+ * A snake moves a single cell per tick, so following its head scrolls by at
+ * most one column and one row. With solid edges, the view stops at the edge
+ * of the world rather than wrapping around it.
+ *
+ *  pt: The point to keep in view, usually the next position of the head.
+ *
+ */
+void follow(point_t pt) {
+	while (centre_offset(pt.x, view.x, MAX_SNAKE_COLUMN, WORLD_COLUMNS) > SCROLL_SLACK_X &&
+		   CAN_SCROLL(view.x, 1, MAX_SNAKE_COLUMN, WORLD_COLUMNS)) {
+		scroll_columns(1);
+	}
+	while (centre_offset(pt.x, view.x, MAX_SNAKE_COLUMN, WORLD_COLUMNS) < -SCROLL_SLACK_X &&
+		   CAN_SCROLL(view.x, -1, MAX_SNAKE_COLUMN, WORLD_COLUMNS)) {
+		scroll_columns(-1);
+	}
+	while (centre_offset(pt.y, view.y, MAX_SNAKE_ROW, WORLD_ROWS) > SCROLL_SLACK_Y &&
+		   CAN_SCROLL(view.y, 1, MAX_SNAKE_ROW, WORLD_ROWS)) {
+		scroll_rows(1);
+	}
+	while (centre_offset(pt.y, view.y, MAX_SNAKE_ROW, WORLD_ROWS) < -SCROLL_SLACK_Y &&
+		   CAN_SCROLL(view.y, -1, MAX_SNAKE_ROW, WORLD_ROWS)) {
+		scroll_rows(-1);
+	}
+	return;
+}
+
+
+/*
+ * Function:  centre_offset
+ * -------------------------
+ * Finds how far a coordinate is from the centre of the view along one axis,
+ * taking the shorter way around the world.
+ *
+ *  val: The coordinate.
+ *  origin: The start of the view along the same axis.
+ *  visible: The size of the view.
+ *  size: The size of the world.
+ *
+ *  returns: The offset, negative if the coordinate is before the centre.
+ *
+ */
+int8_t centre_offset(int8_t val, int8_t origin, uint8_t visible, uint8_t size) {
+	int8_t offset = bound_check(val - origin, 0, size) - visible/2;
+	if (offset >= size/2) offset -= size;
+	return offset;
+}
+
+
+/*
+ * Function:  scroll_columns
+ * --------------------------
+ * Moves the view a column right (step > 0) or left. The column coming into
+ * view takes over the buffer slot and screen column of the one going out.
+ *
+ */
+void scroll_columns(int8_t step) {
+	uint32_t start = get_cycles();
+	int8_t x;
+	
+	if (step > 0) {
+		x = bound_check(view.x + MAX_SNAKE_COLUMN, 0, WORLD_COLUMNS);
+		view.x = bound_check(view.x + 1, 0, WORLD_COLUMNS);
+	} else {
+		view.x = bound_check(view.x - 1, 0, WORLD_COLUMNS);
+		x = view.x;
+	}
+	load_world_column(x);
+	scroll_stats.lcd_bytes += draw_screen_column(x % MAX_SNAKE_COLUMN);
+	scroll_stats.columns++;
+	scroll_stats.cycles += get_cycles() - start;
+	return;
+}
+
+
+/*
+ * Function:  scroll_rows
+ * -----------------------
+ * Moves the view a row down (step > 0) or up, as scroll_columns() does.
+ *
+ */
+void scroll_rows(int8_t step) {
+	uint32_t start = get_cycles();
+	int8_t y;
+	
+	if (step > 0) {
+		y = bound_check(view.y + MAX_SNAKE_ROW, 0, WORLD_ROWS);
+		view.y = bound_check(view.y + 1, 0, WORLD_ROWS);
+	} else {
+		view.y = bound_check(view.y - 1, 0, WORLD_ROWS);
+		y = view.y;
+	}
+	load_world_row(y);
+	scroll_stats.lcd_bytes += draw_screen_row(y % MAX_SNAKE_ROW);
+	scroll_stats.rows++;
+	scroll_stats.cycles += get_cycles() - start;
+	return;
+}
+
+
+/*
+ * Function:  load_world_column
+ * -----------------------------
+ * Reads the visible part of a world column from FRAM into its buffer slot.
+ * Unless the view lines up with a screen, the rows in view start part of 
+ * the way down one screen and end in the next, so both screens of the 
+ * column are read and merged. Slot rows from the top of the view's first
+ * row onwards belong to the first screen, the rest to the second.
+ *
+ *  x: The world column.
+ *
+ */
+void load_world_column(int8_t x) {
+	byte first[MAX_SNAKE_PAGE], second[MAX_SNAKE_PAGE] = {OFF}, mask;
+	uint8_t page, row, split = view.y % MAX_SNAKE_ROW;
+	point_t pt;
+	
+	pt.x = x;
+	pt.y = view.y - split;
+	fram_read(world_address(pt), first, MAX_SNAKE_PAGE);
+	if (split != 0) {
+		pt.y = bound_check(pt.y + MAX_SNAKE_ROW, 0, WORLD_ROWS);
+		fram_read(world_address(pt), second, MAX_SNAKE_PAGE);
+	}
+	
+	for (page = 0; page < MAX_SNAKE_PAGE; page++) {
+		row = page*SNAKE_ROWS_PER_PAGE;
+		if (split <= row) {
+			mask = ALL;
+		} else if (split >= row + SNAKE_ROWS_PER_PAGE) {
+			mask = OFF;
+		} else {
+			mask = ALL << (SNAKE_ROW_BIT_SIZE*(split - row));
+		}
+		walls[x % MAX_SNAKE_COLUMN][page] = (first[page] & mask) | (second[page] & ~mask);
+	}
+	return;
+}
+
+
+/*
+ * Function:  load_world_row
+ * --------------------------
+ * Reads the visible part of a world row from FRAM into its buffer slots. 
+ * The world is stored by column, so this costs a read per column.
+ *
+ *  y: The world row.
+ *
+ */
+void load_world_row(int8_t y) {
+	point_t pt;
+	uint8_t i;
+	
+	pt.y = y;
+	for (i = 0; i < MAX_SNAKE_COLUMN; i++) {
+		pt.x = bound_check(view.x + i, 0, WORLD_COLUMNS);
+		cache_cell(pt, read_world_cell(pt));
+	}
+	return;
+}
+
+
+/*
+ * Function:  world_address
+ * -------------------------
+ *  returns: The FRAM address of the byte holding a world cell.
+ *
+ */
+uint16_t world_address(point_t pt) {
+	uint16_t screen = (uint16_t)pt.x*WORLD_SCREENS_Y + pt.y/MAX_SNAKE_ROW;
+	return WORLD_BASE + screen*MAX_SNAKE_PAGE + (pt.y % MAX_SNAKE_ROW)/SNAKE_ROWS_PER_PAGE;
+}
+
+obj_t read_world_cell(point_t pt) {
+	address_t loc = pt2bufferaddress(pt);
+	return GET(0b11, fram_read_byte(world_address(pt)) >> loc.bit);
+}
+
+void write_world_cell(point_t pt, obj_t object) {
+	address_t loc = pt2bufferaddress(pt);
+	uint16_t address = world_address(pt);
+	byte data = fram_read_byte(address);
+	SET(data, (0b11 << loc.bit), (object << loc.bit));
+	fram_write_byte(address, data);
+	return;
+}
+
+
+/*
+ * Function:  store_world
+ * -----------------------
+ * Tiles the level in the walls buffer over every screen of the world. The view
+ * must be at the top-left screen, see reset_view().
+ *
+ */
+void store_world(void) {
+	byte column[WORLD_COLUMN_BYTES];
+	uint8_t i;
+	point_t pt = {0, 0};
+	
+	for (pt.x = 0; pt.x < WORLD_COLUMNS; pt.x++) {
+		for (i = 0; i < WORLD_COLUMN_BYTES; i++) {
+			column[i] = walls[pt.x % MAX_SNAKE_COLUMN][i % MAX_SNAKE_PAGE];
+		}
+		fram_write(world_address(pt), column, WORLD_COLUMN_BYTES);
+	}
+	return;
+}
+
+void clear_world(void) {
+	fram_fill(WORLD_BASE, OFF, WORLD_BYTES);
+	return;
+}
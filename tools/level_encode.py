@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Title: Level encoder
+Author: Patrick Lewien (694555)
+
+DESCRIPTION:
+	Turns the ASCII level maps in levels.txt into the run-length encoded
+	PROGMEM arrays used by level.c.
+
+	Cells are visited in the order they are stored in the walls buffer:
+	column by column, and within a column four rows to a byte, starting
+	from the least significant bits. The two unused rows at the bottom of
+	each column are stored as empty. Each code is one byte, with the object
+	in the top two bits and the run length minus one in the rest. As walls
+	tend to run across the screen rather than down it, a code with the 
+	SPECIAL object instead repeats the previous column that many times.
+
+	usage: level_encode.py levels.txt > levels.inc
+"""
+
+import sys
+
+COLUMNS, ROWS, PAGES = 25, 14, 4
+ROWS_PER_PAGE = 4
+MAX_RUN = 64
+OBJECTS = {".": 0b00, "#": 0b01}
+REPEAT = 0b11  # SPECIAL never appears in a map, so it marks a repeated column
+
+
+def read_levels(path):
+	levels, name = [], None
+	with open(path) as text:
+		for line in text:
+			line = line.rstrip("\n")
+			if line.startswith("#") and name is None or not line.strip():
+				continue
+			if line.startswith("level:"):
+				name = line.split(":", 1)[1].strip()
+				levels.append((name, []))
+				continue
+			levels[-1][1].append(line)
+	for name, rows in levels:
+		if len(rows) != ROWS or any(len(row) != COLUMNS for row in rows):
+			sys.exit("level %s is not %dx%d" % (name, COLUMNS, ROWS))
+	return levels
+
+
+def encode(rows):
+	codes, run, repeat, previous = [], None, 0, None
+	for x in range(COLUMNS):
+		column = [OBJECTS[rows[y][x]] if y < ROWS else 0 for y in range(PAGES * ROWS_PER_PAGE)]
+		if column == previous:
+			if run:
+				codes.append(run)
+				run = None
+			repeat += 1
+			if repeat == MAX_RUN:
+				codes.append([REPEAT, repeat])
+				repeat = 0
+			continue
+		if repeat:
+			codes.append([REPEAT, repeat])
+			repeat = 0
+		for cell in column:
+			if run and run[0] == cell and run[1] < MAX_RUN:
+				run[1] += 1
+			else:
+				if run:
+					codes.append(run)
+				run = [cell, 1]
+		previous = column
+	codes += [run] if run else []
+	codes += [[REPEAT, repeat]] if repeat else []
+	return [(code << 6) | (length - 1) for code, length in codes]
+
+
+def main(argv):
+	if len(argv) != 2:
+		print(__doc__.split("usage: ")[1].strip())
+		return 1
+	for name, rows in read_levels(argv[1]):
+		data = encode(rows)
+		print("/*")
+		for row in rows:
+			print(" *\t" + row)
+		print(" */")
+		print("static const byte level_%s[] PROGMEM = {" % name)
+		for i in range(0, len(data), 12):
+			print("\t" + ", ".join("0x%02X" % b for b in data[i:i+12]) + ",")
+		print("};\t// %d bytes\n" % len(data))
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
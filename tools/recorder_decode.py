@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Title: Flight recorder decoder
+Author: Patrick Lewien (694555)
+
+DESCRIPTION:
+	Lists the events logged by recorder.c, oldest first, from an image of
+	the whole FRAM: host/fram.bin from the host build, or a dump of the
+	console's FRAM chip. Ticks are counted since power-up, using the 
+	REC_TICKS event recorded every 256 ticks.
+
+	The log starts straight after the world, so a build with another size
+	of world, e.g. make RULES="-DWORLD_SCREENS_X=1 -DWORLD_SCREENS_Y=1",
+	is decoded with the same size: -x 1 -y 1.
+
+	usage: recorder_decode.py [-x screens] [-y screens] [fram.bin]
+"""
+
+import argparse
+import struct
+import sys
+
+# keep in step with recorder.h, world.h and snake.h
+FRAM_SIZE = 2048
+SCREEN_COLUMNS = 25  # MAX_SNAKE_COLUMN
+SCREEN_PAGES = 4  # MAX_SNAKE_PAGE, bytes of a column of a screen
+HEADER = struct.Struct("<2sBBHH")
+EVENT_BYTES = 3
+MAX_EVENTS = 255  # RECORDER_MAX_EVENTS, as the header's next slot is a byte
+MAGIC = b"FR"
+
+STATES = ["running", "game over", "fault"]
+FAULTS = ["none", "heap exhausted"]
+DIRECTIONS = ["up", "down", "left", "right", "none"]
+CRASHES = ["wall", "head-on"]
+
+
+def describe(kind, data, value):
+	if kind == 0:
+		return "start    level %d, %d snakes" % (value, data)
+	if kind == 1:
+		return "turn     snake %d %s" % (data, DIRECTIONS[value] if value < len(DIRECTIONS) else value)
+	if kind == 2:
+		return "food     (%d, %d)" % ((data << 2) | (value >> 6), value & 0x3F)
+	if kind == 3:
+		return "length   snake %d grows to %d" % (data, value)
+	if kind == 4:
+		return "overrun  %s%d ms late" % (">=" if value == 0xFF else "", value)
+	if kind == 5:
+		return "crash    snake %d, %s" % (data, CRASHES[value] if value < len(CRASHES) else value)
+	if kind == 6:
+		if value == 2:
+			return "end      fault: %s" % (FAULTS[data] if data < len(FAULTS) else data)
+		return "end      %s" % (STATES[value] if value < len(STATES) else value)
+	return "ticks    %d%s" % (value << 8, "" if value else ", e.g. after power-up")
+
+
+def layout(screens_x, screens_y):
+	"""Returns RECORDER_BASE and RECORDER_EVENTS for a world of this many screens."""
+	base = SCREEN_COLUMNS * screens_x * SCREEN_PAGES * screens_y  # WORLD_BYTES
+	return base, min((FRAM_SIZE - base - HEADER.size) // EVENT_BYTES, MAX_EVENTS)
+
+
+def read_log(image, base, events_held):
+	magic, state, next_slot, total, lost = HEADER.unpack_from(image, base)
+	if magic != MAGIC or next_slot >= events_held:
+		raise ValueError("no flight recorder log in this image")
+	count = min(total, events_held)
+	first = (next_slot - count) % events_held
+	events = []
+	for i in range(count):
+		offset = base + HEADER.size + ((first + i) % events_held) * EVENT_BYTES
+		tick, kind, value = image[offset:offset + EVENT_BYTES]
+		events.append((tick, kind >> 5, kind & 0x1F, value))
+	return state, total, lost, events
+
+
+def main(argv):
+	parser = argparse.ArgumentParser(description="Lists the flight recorder's log from an FRAM image.")
+	parser.add_argument("-x", "--screens-x", type=int, default=4, help="WORLD_SCREENS_X of the build")
+	parser.add_argument("-y", "--screens-y", type=int, default=4, help="WORLD_SCREENS_Y of the build")
+	parser.add_argument("path", nargs="?", default="fram.bin")
+	args = parser.parse_args(argv[1:])
+	base, events_held = layout(args.screens_x, args.screens_y)
+	if base + HEADER.size > FRAM_SIZE:
+		sys.stderr.write("a world of %dx%d screens leaves no room for the log\n" % (args.screens_x, args.screens_y))
+		return 2
+
+	path = args.path
+	with open(path, "rb") as f:
+		image = f.read()
+	if len(image) < FRAM_SIZE:
+		image += bytes(FRAM_SIZE - len(image))  # the host only writes what has been used
+	try:
+		state, total, lost, events = read_log(image, base, events_held)
+	except ValueError as error:
+		sys.stderr.write("%s: %s\n" % (path, error))
+		return 1
+
+	print("last written: %s, %d events logged, %d lost before they were saved"
+		% (STATES[state] if state < len(STATES) else state, total, lost))
+	high, last = 0, None
+	for tick, kind, data, value in events:
+		if kind == 7:
+			high = value << 8
+		elif last is not None and tick < last:
+			high += 0x100  # no REC_TICKS since it wrapped, e.g. it was lost
+		last = tick
+		print("%6d  %s" % (high | tick, describe(kind, data, value)))
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
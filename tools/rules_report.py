@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Title: Rules report
+Author: Patrick Lewien (694555)
+
+DESCRIPTION:
+	Builds the game once for each variant of the rules in rules.h, and
+	reports what each costs: the cycles of the logic of a tick, from the
+	telemetry of scripted games played on the host, and the size of the
+	code. The code is sized with avr-gcc and avr-size if they are on the
+	PATH, as flash on the ATmega16, or else with the host compiler at -Os,
+	which is only good for comparing the variants with each other. The
+	host's cycles are wall-clock time scaled to F_CPU, so compare them
+	within a run. Nothing is written to the build trees.
+
+	The last variant, full board, is built with a world of one screen and
+	plays the game of time_full_board(), snake_telemetry -f, until the
+	snake fills the board, so the worst case of a tick is measured too.
+
+	usage: rules_report.py [-t ticks] [-s seeds] [-l lcdlib] [-D RULE=VALUE ...]
+
+	-D adds a variant of its own, e.g. -D RULE_EDGES=EDGES_SOLID.
+"""
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+SRC = os.path.join(ROOT, "src")
+INCLUDE = os.path.join(ROOT, "include")
+HOST = os.path.join(ROOT, "host")
+sys.path.insert(0, TOOLS)
+import telemetry_decode  # noqa: E402
+
+# keep in step with host/Makefile and src/Makefile.mk
+HOST_FLAGS = ["-std=gnu99", "-O2", "-fsigned-char", "-fshort-enums", "-DHOST", "-DBENCHMARK",
+	"-DTELEMETRY", "-DF_CPU=7379300UL", "-I" + os.path.join(HOST, "include"), "-I" + HOST, "-I" + INCLUDE]
+AVR_FLAGS = ["-mmcu=atmega16", "-Os", "-fsigned-char", "-fshort-enums", "-DF_CPU=7379300UL",
+	"-I" + INCLUDE]
+STEP_OBJECTS = ["play", "snake", "world"]  # the step and collision code
+
+VARIANTS = [
+	("wrap", []),
+	("solid", ["-DRULE_EDGES=EDGES_SOLID"]),
+	("taper", ["-DRULE_GROWTH=GROWTH_TAPER"]),
+	("no growth", ["-DRULE_GROWTH=GROWTH_NONE"]),
+	("ramp", ["-DRULE_SPEED=SPEED_RAMP"]),
+	("stream body", ["-DRULE_BODY=BODY_STREAM"]),
+	("solid taper ramp", ["-DRULE_EDGES=EDGES_SOLID", "-DRULE_GROWTH=GROWTH_TAPER",
+		"-DRULE_SPEED=SPEED_RAMP"]),
+]
+# time_full_board() needs a world of one screen, which the default build is not
+FULL_BOARD = ("full board", ["-DWORLD_SCREENS_X=1", "-DWORLD_SCREENS_Y=1"])
+FULL_BOARD_TICKS = 30000  # FULL_BOARD_MAX_TICKS
+
+
+def objects(makefile, name):
+	with open(makefile) as f:
+		match = re.search(r"^%s\s*=\s*(.*)$" % name, f.read(), re.M)
+	return [o[:-2] for o in match.group(1).split()]
+
+
+def compile_all(compiler, flags, sources, directory):
+	built = []
+	for path in sources:
+		name = os.path.splitext(os.path.basename(path))[0]
+		out = os.path.join(directory, name + ".o")
+		extra = ["-Dmain=console_main"] if name == "console" and "-DHOST" in flags else []
+		subprocess.run([compiler] + flags + extra + ["-c", path, "-o", out], check=True)
+		built.append(out)
+	return built
+
+
+def measure_cycles(rules, ticks, seeds, directory, full=False):
+	game = [os.path.join(SRC, o + ".c") for o in objects(os.path.join(HOST, "Makefile"), "_GAME")]
+	emu = [os.path.join(HOST, o + ".c") for o in objects(os.path.join(HOST, "Makefile"), "_EMU")]
+	built = compile_all("gcc", HOST_FLAGS + rules, game + emu + [os.path.join(HOST, "snake_telemetry.c")],
+		directory)
+	binary = os.path.join(directory, "snake_telemetry")
+	subprocess.run(["gcc"] + built + ["-o", binary], check=True)
+
+	cycles = []
+	for seed in range(1, seeds + 1):
+		env = dict(os.environ, SNAKE_FRAM=os.path.join(directory, "fram.bin"))
+		args = ["-f", "-t", str(FULL_BOARD_TICKS)] if full else ["-t", str(ticks)]
+		stream = subprocess.run([binary, "-s", str(seed)] + args, env=env,
+			stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, check=True).stdout
+		cycles += [frame[1] for frame in telemetry_decode.decode([stream])]
+	return sum(cycles) // max(len(cycles), 1), max(cycles, default=0)
+
+
+def measure_size(rules, lcdlib, directory):
+	"""Returns (total, step code) in bytes, and what they were measured as."""
+	if shutil.which("avr-gcc") and shutil.which("avr-size"):
+		names = objects(os.path.join(SRC, "Makefile.mk"), "_OBJ")
+		compiler, flags, size, kind = "avr-gcc", AVR_FLAGS + ["-I" + lcdlib] + rules, "avr-size", "flash"
+	else:
+		names = objects(os.path.join(HOST, "Makefile"), "_GAME")
+		flags = [f for f in HOST_FLAGS if f not in ("-O2", "-DBENCHMARK", "-DTELEMETRY")] + ["-Os"] + rules
+		compiler, size, kind = "gcc", "size", "host -Os text"
+	built = compile_all(compiler, flags, [os.path.join(SRC, n + ".c") for n in names], directory)
+	output = subprocess.run([size] + built, stdout=subprocess.PIPE, check=True, text=True).stdout
+	total = step = 0
+	for line in output.splitlines()[1:]:
+		fields = line.split()
+		text, data = int(fields[0]), int(fields[1])
+		total += text + data
+		if os.path.splitext(os.path.basename(fields[-1]))[0] in STEP_OBJECTS:
+			step += text
+	return total, step, kind
+
+
+def main(argv):
+	parser = argparse.ArgumentParser(description="Cycles and code size of each variant of the rules.")
+	parser.add_argument("-t", "--ticks", type=int, default=1000)
+	parser.add_argument("-s", "--seeds", type=int, default=3)
+	parser.add_argument("-l", "--lcdlib", default=os.path.join(ROOT, "..", "lcdlib"))
+	parser.add_argument("-D", dest="defines", action="append", default=[])
+	args = parser.parse_args(argv[1:])
+
+	variants = VARIANTS + [FULL_BOARD]
+	if args.defines:
+		variants = [VARIANTS[0], (" ".join(args.defines), ["-D" + d for d in args.defines])]
+
+	print("variant,rules,mean_cycles,max_cycles,code_bytes,step_code_bytes,sized_as")
+	for name, rules in variants:
+		with tempfile.TemporaryDirectory() as directory:
+			mean, worst = measure_cycles(rules, args.ticks, args.seeds, directory, (name, rules) == FULL_BOARD)
+			total, step, kind = measure_size(rules, args.lcdlib, directory)
+		print("%s,%s,%d,%d,%d,%d,%s" % (name, " ".join(rules) or "defaults", mean, worst, total, step, kind))
+		sys.stdout.flush()
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
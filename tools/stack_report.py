@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Title: Static stack-depth report
+Author: Patrick Lewien (694555)
+
+DESCRIPTION:
+	Works out the worst-case stack depth of every call path from main(),
+	play_snake_game() and each ISR, so pools and buffers can be sized
+	against the 1 KB of SRAM with some confidence.
+
+	Frame sizes come from the .su files written by -fstack-usage. Call
+	edges come from the disassembly of the linked elf, so calls into
+	avr-libc and lcdlib are followed too. Library functions without a .su
+	file are estimated from the number of registers they push.
+
+	usage: stack_report.py <objdump -d output> <.su directory>...
+"""
+
+import os
+import re
+import sys
+
+RETURN_ADDRESS = 2  # bytes pushed per call on a 16-bit PC
+ROOTS = ["main", "play_snake_game"]
+
+# Called through the module table in module.c, so they never show up as call
+# edges. Every indirect call is taken to reach any of them.
+MODULE_HOOKS = [
+	"start_solo_snake", "start_versus_snake", "start_duel_snake",
+	"step_snake_game", "render_snake_game", "end_snake_game", "restart_snake_game",
+	"start_latency_screen", "step_latency_screen", "render_latency_screen", "end_latency_screen",
+]
+
+FUNCTION = re.compile(r"^[0-9a-f]+ <([\w.]+)>:")
+CALL = re.compile(r"\b(r?call|r?jmp)\b.*<([\w.]+)>\s*$")
+INDIRECT = re.compile(r"\b(e?icall|e?ijmp)\b")
+PUSH = re.compile(r"\bpush\b")
+
+
+def read_frames(directories):
+	frames = {}
+	for directory in directories:
+		for root, _, files in os.walk(directory):
+			for name in files:
+				if not name.endswith(".su"):
+					continue
+				with open(os.path.join(root, name)) as su:
+					for line in su:
+						location, size, _ = line.rstrip("\n").split("\t")
+						frames[location.split(":")[-1]] = int(size)
+	return frames
+
+
+def read_calls(disassembly):
+	calls, pushes, indirect = {}, {}, set()
+	function = None
+	with open(disassembly) as dump:
+		for line in dump:
+			match = FUNCTION.match(line)
+			if match:
+				function = match.group(1)
+				calls.setdefault(function, set())
+				pushes[function] = 0
+				continue
+			if function is None:
+				continue
+			match = CALL.search(line)
+			if match and match.group(2) != function:
+				tail = match.group(1).endswith("jmp")
+				calls[function].add((match.group(2), tail))
+			if INDIRECT.search(line):
+				indirect.add(function)
+			if PUSH.search(line):
+				pushes[function] += 1
+	for function in indirect:
+		calls[function].update((hook, False) for hook in MODULE_HOOKS if hook in calls)
+	return calls, pushes, indirect
+
+
+def worst_path(function, calls, frames, pushes, stack=()):
+	"""Returns (depth, path, bounded) for the deepest path below function."""
+	if function in stack:
+		return 0, [function + " (recursive)"], False
+	frame = frames.get(function, pushes.get(function, 0))
+	depth, path, bounded = 0, [], True
+	for callee, tail in calls.get(function, ()):
+		d, p, b = worst_path(callee, calls, frames, pushes, stack + (function,))
+		d += 0 if tail else RETURN_ADDRESS
+		bounded = bounded and b
+		if d > depth:
+			depth, path = d, p
+	return frame + depth, [function] + path, bounded
+
+
+def main(argv):
+	if len(argv) < 3:
+		print(__doc__.split("usage: ")[1].strip())
+		return 1
+	calls, pushes, indirect = read_calls(argv[1])
+	frames = read_frames(argv[2:])
+	vectors = sorted(f for f in calls if re.match(r"__vector_\d+$", f))
+
+	worst_isr = 0
+	print("%-20s %6s  %s" % ("root", "bytes", "deepest path"))
+	for root in ROOTS + vectors:
+		if root not in calls:
+			continue
+		depth, path, bounded = worst_path(root, calls, frames, pushes)
+		if root in vectors:
+			depth += RETURN_ADDRESS  # interrupted PC
+			worst_isr = max(worst_isr, depth)
+		note = "" if bounded else "  UNBOUNDED"
+		print("%-20s %6d  %s%s" % (root, depth, " > ".join(path), note))
+
+	depth, _, _ = worst_path("main", calls, frames, pushes)
+	print("%-20s %6d  main + deepest ISR (interrupts do not nest)" % ("total", depth + worst_isr))
+
+	estimated = sorted(f for f in pushes if f not in frames and pushes[f])
+	if estimated:
+		print("\nestimated from pushes: " + ", ".join(estimated))
+	if indirect:
+		print("indirect calls not followed in: " + ", ".join(sorted(indirect)))
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Title: Telemetry decoder
+Author: Patrick Lewien (694555)
+
+DESCRIPTION:
+	Turns the telemetry stream sent by telemetry.c into CSV, one row per
+	tick. Reads a serial port (or pseudo-terminal) until it is closed, or
+	a capture file, or stdin. The port must already be set to 38400 8N1, 
+	e.g. with stty; only raw mode is set here, if need be.
+
+	Frames start with a sync byte and end with a checksum of the payload.
+	Bytes that do not form a valid frame are skipped until the next sync,
+	so decoding can start part-way through a stream.
+
+	The latency column is left empty for ticks that acted on no arrow
+	key. The presses timed are summed up as a histogram on stderr, in the
+	same bins as the console's latency screen.
+
+	usage: telemetry_decode.py [port or file] > telemetry.csv
+"""
+
+import os
+import struct
+import sys
+import termios
+import tty
+
+SYNC = 0xA5
+PAYLOAD = struct.Struct("<HIIHHBBH")  # keep in step with send_telemetry()
+FIELDS = ["tick", "logic_cycles", "render_cycles", "spi_bytes", "free_ram", "length", "segments",
+	"latency_ms"]
+LATENCY_NONE = 0xFFFF
+LATENCY_BINS = 16  # keep in step with latency.h
+LATENCY_BIN_MS = 16
+
+
+def read_stream(path):
+	if path in (None, "-"):
+		fd = sys.stdin.fileno()
+	else:
+		fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+	# Changing the settings of a raw port can drop what it has buffered
+	if os.isatty(fd) and termios.tcgetattr(fd)[3] & termios.ICANON:
+		tty.setraw(fd, termios.TCSANOW)
+	while True:
+		try:
+			chunk = os.read(fd, 4096)
+		except OSError:  # the other end of a pty hung up
+			break
+		if not chunk:
+			break
+		yield chunk
+
+
+def decode(chunks):
+	"""Yields the payload of each valid frame, and counts the bytes skipped."""
+	buffer, skipped = bytearray(), 0
+	for chunk in chunks:
+		buffer += chunk
+		while len(buffer) >= PAYLOAD.size + 2:
+			if buffer[0] != SYNC:
+				del buffer[0]
+				skipped += 1
+				continue
+			payload = buffer[1:1 + PAYLOAD.size]
+			if sum(payload) & 0xFF != buffer[1 + PAYLOAD.size]:
+				del buffer[0]
+				skipped += 1
+				continue
+			yield PAYLOAD.unpack(payload)
+			del buffer[:PAYLOAD.size + 2]
+	decode.skipped = skipped + len(buffer)
+
+
+def report_latency(latencies):
+	if not latencies:
+		return
+	bins = [0] * LATENCY_BINS
+	for ms in latencies:
+		bins[min(ms // LATENCY_BIN_MS, LATENCY_BINS - 1)] += 1
+	sys.stderr.write("%d presses, mean %d ms, worst %d ms\n"
+		% (len(latencies), sum(latencies) // len(latencies), max(latencies)))
+	for i, count in enumerate(bins):
+		label = "%3d-%d" % (i * LATENCY_BIN_MS, (i + 1) * LATENCY_BIN_MS - 1)
+		if i == LATENCY_BINS - 1:
+			label = "%3d+" % (i * LATENCY_BIN_MS)
+		sys.stderr.write("%8s ms %5d %s\n" % (label, count, "#" * (count * 50 // max(bins))))
+
+
+def main(argv):
+	path = argv[1] if len(argv) > 1 else None
+	frames, latencies = 0, []
+	print(",".join(FIELDS))
+	for values in decode(read_stream(path)):
+		latency = values[-1]
+		if latency == LATENCY_NONE:
+			values = values[:-1] + ("",)
+		else:
+			latencies.append(latency)
+		print(",".join(str(v) for v in values))
+		frames += 1
+	sys.stderr.write("%d frames, %d bytes skipped\n" % (frames, decode.skipped))
+	report_latency(latencies)
+	return 0
+
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv))